@@ -37,7 +37,7 @@ namespace lsp
             static constexpr float HORIZONTAL_DIVISION_DFL      = 0.5;
             static constexpr float HORIZONTAL_DIVISION_STEP     = 1e-3f;
 
-            static constexpr float TIME_DIVISION_MAX            = 50.0f;
+            static constexpr float TIME_DIVISION_MAX            = 5000.0f;
             static constexpr float TIME_DIVISION_MIN            = 0.05f;
             static constexpr float TIME_DIVISION_DFL            = 1.0f;
             static constexpr float TIME_DIVISION_STEP           = 0.01f;
@@ -72,6 +72,29 @@ namespace lsp
             static constexpr float MAXDOTS_DFL                  = 8192.0f;
             static constexpr float MAXDOTS_STEP                 = 0.01f;
 
+            static constexpr float SILENCE_THRESHOLD_MAX        = GAIN_AMP_M_60_DB;
+            static constexpr float SILENCE_THRESHOLD_MIN        = GAIN_AMP_M_120_DB;
+            static constexpr float SILENCE_THRESHOLD_DFL        = GAIN_AMP_M_100_DB;
+            static constexpr float SILENCE_THRESHOLD_STEP       = 0.01f;
+
+            static constexpr float PHOSPHOR_DECAY_MAX           = 10000.0f;
+            static constexpr float PHOSPHOR_DECAY_MIN           = 10.0f;
+            static constexpr float PHOSPHOR_DECAY_DFL           = 300.0f;
+            static constexpr float PHOSPHOR_DECAY_STEP          = 0.01f;
+
+            static constexpr size_t SEGMENTS_MAX                = 64;
+            static constexpr size_t SEGMENTS_MIN                = 1;
+            static constexpr size_t SEGMENTS_DFL                = 1;
+            static constexpr size_t SEGMENTS_STEP               = 1;
+
+            static constexpr size_t AVERAGE_COUNT_MAX           = 256;
+            static constexpr size_t AVERAGE_COUNT_MIN           = 2;
+            static constexpr size_t AVERAGE_COUNT_DFL           = 16;
+            static constexpr size_t AVERAGE_COUNT_STEP          = 1;
+
+            static constexpr size_t PHOSPHOR_ROWS               = 256;
+            static constexpr size_t PHOSPHOR_COLS               = 512;
+
             static constexpr float TRIGGER_HYSTERESIS_MAX       = 50.0f;
             static constexpr float TRIGGER_HYSTERESIS_MIN       = 0.0f;
             static constexpr float TRIGGER_HYSTERESIS_DFL       = 1.0f;
@@ -95,6 +118,7 @@ namespace lsp
                 OSC_OVS_4X,
                 OSC_OVS_6X,
                 OSC_OVS_8X,
+                OSC_OVS_AUTO,
 
                 OSC_OVS_DFL = OSC_OVS_8X
             };
@@ -153,6 +177,14 @@ namespace lsp
                 COUPLING_DFL = COUPLING_DC
             };
 
+            enum acquisition_mode_selector_t
+            {
+                ACQUISITION_NORMAL,
+                ACQUISITION_AVERAGE,
+
+                ACQUISITION_DFL = ACQUISITION_NORMAL
+            };
+
             static constexpr size_t SCOPE_MESH_SIZE = 512;
         };
 
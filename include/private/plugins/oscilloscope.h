@@ -24,11 +24,13 @@
 
 #include <lsp-plug.in/plug-fw/plug.h>
 #include <lsp-plug.in/plug-fw/core/IDBuffer.h>
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/ipc/Condition.h>
+#include <lsp-plug.in/ipc/ITask.h>
+#include <lsp-plug.in/ipc/Thread.h>
 #include <lsp-plug.in/dsp-units/filters/FilterBank.h>
-#include <lsp-plug.in/dsp-units/util/Delay.h>
 #include <lsp-plug.in/dsp-units/util/Oversampler.h>
 #include <lsp-plug.in/dsp-units/util/Oscillator.h>
-#include <lsp-plug.in/dsp-units/util/Trigger.h>
 
 #include <private/meta/oscilloscope.h>
 
@@ -68,7 +70,9 @@ namespace lsp
                     UPD_TRIGGER_INPUT       = 1 << 12,
                     UPD_TRIGGER_HOLD        = 1 << 13,
                     UPD_TRIGGER             = 1 << 14,
-                    UPD_TRGGER_RESET        = 1 << 15
+                    UPD_TRGGER_RESET        = 1 << 15,
+                    UPD_TRIGGER_RATE        = 1 << 16,
+                    UPD_OVERSAMPLER_AUTO    = 1 << 17
                 };
 
                 enum ch_mode_t
@@ -97,6 +101,33 @@ namespace lsp
                     CH_TRG_INPUT_DFL = CH_TRG_INPUT_Y
                 };
 
+                enum ch_trg_mode_t
+                {
+                    CH_TRG_MODE_SINGLE,
+                    CH_TRG_MODE_MANUAL,
+                    CH_TRG_MODE_REPEAT,
+
+                    CH_TRG_MODE_DFL = CH_TRG_MODE_REPEAT
+                };
+
+                enum ch_trg_type_t
+                {
+                    CH_TRG_TYPE_NONE,
+                    CH_TRG_TYPE_SIMPLE_RISING_EDGE,
+                    CH_TRG_TYPE_SIMPLE_FALLING_EDGE,
+                    CH_TRG_TYPE_ADVANCED_RISING_EDGE,
+                    CH_TRG_TYPE_ADVANCED_FALLING_EDGE,
+
+                    CH_TRG_TYPE_DFL = CH_TRG_TYPE_NONE
+                };
+
+                enum ch_input_t
+                {
+                    CH_INPUT_X              = 1 << 0,
+                    CH_INPUT_Y              = 1 << 1,
+                    CH_INPUT_EXT            = 1 << 2
+                };
+
                 enum ch_coupling_t
                 {
                     CH_COUPLING_AC,
@@ -111,12 +142,137 @@ namespace lsp
                     CH_STATE_SWEEPING
                 };
 
+                enum ch_acquisition_t
+                {
+                    CH_ACQUISITION_NORMAL,
+                    CH_ACQUISITION_AVERAGE,
+
+                    CH_ACQUISITION_DFL = CH_ACQUISITION_NORMAL
+                };
+
+                enum ch_frame_t
+                {
+                    CH_FRAME_NONE,                      // Frame buffers are free
+                    CH_FRAME_PENDING,                   // Completed trace is passed to the decimator
+                    CH_FRAME_DECIMATING,                // Trace is claimed by the decimator
+                    CH_FRAME_READY                      // Decimated trace is ready to be passed to the UI
+                };
+
+                class ArenaAllocator: public ipc::ITask
+                {
+                    private:
+                        oscilloscope       *pCore;
+
+                    public:
+                        explicit ArenaAllocator(oscilloscope *core);
+                        virtual ~ArenaAllocator() override;
+
+                    public:
+                        virtual status_t    run() override;
+                };
+
+                class FrameDecimator: public ipc::ITask
+                {
+                    private:
+                        oscilloscope       *pCore;
+
+                    public:
+                        explicit FrameDecimator(oscilloscope *core);
+                        virtual ~FrameDecimator() override;
+
+                    public:
+                        virtual status_t    run() override;
+                };
+
+                class WorkerLauncher: public ipc::ITask
+                {
+                    private:
+                        oscilloscope       *pCore;
+
+                    public:
+                        explicit WorkerLauncher(oscilloscope *core);
+                        virtual ~WorkerLauncher() override;
+
+                    public:
+                        virtual status_t    run() override;
+                };
+
+                typedef struct ch_scratch_t
+                {
+                    float                  *vTemp;
+                    float                  *vData_x;
+                    float                  *vData_y;
+                    float                  *vData_ext;
+                    bool                    bAudio;         // Buffers of the audio thread which may access streams
+                } ch_scratch_t;
+
+                class ChannelWorker: public ipc::Thread
+                {
+                    private:
+                        oscilloscope       *pCore;
+                        const ch_scratch_t *pScratch;
+
+                    public:
+                        explicit ChannelWorker(oscilloscope *core, const ch_scratch_t *scratch);
+                        virtual ~ChannelWorker() override;
+
+                    public:
+                        virtual status_t    run() override;
+                };
+
                 typedef struct dc_block_t
                 {
                     float   fAlpha;
                     float   fGain;
                 } dc_block_t;
 
+                typedef struct ch_buffers_t
+                {
+                    size_t  nDisplay;           // Size of each display buffer
+                    size_t  nCapture;           // Size of the capture buffer
+                    size_t  nSweep;             // Size of the sweep table
+                    size_t  nPhosphor;          // Size of the phosphor hit histogram
+                    size_t  nSegments;          // Size of the segment memory
+                    size_t  nAverage;           // Size of the averaging buffer
+                } ch_buffers_t;
+
+                typedef struct ch_trigger_t
+                {
+                    ch_trg_mode_t           enMode;         // Trigger mode
+                    ch_trg_type_t           enType;         // Trigger type
+                    float                   fArmLevel;      // The signal should pass this level to arm the trigger
+                    float                   fFireLevel;     // The signal should reach this level to fire the armed trigger
+                    size_t                  nHold;          // Minimum number of samples between two fires
+                    size_t                  nHoldCounter;   // Number of samples passed since the last fire
+                    bool                    bRising;        // Trigger fires on the rising edge
+                    bool                    bArmed;         // Trigger is armed
+                    bool                    bSingleLock;    // Single trigger has already fired
+                    bool                    bManualAllow;   // Manual trigger is allowed to fire
+                } ch_trigger_t;
+
+                typedef struct ch_peak_t
+                {
+                    float                   fMin;           // Minimum of the incomplete group of samples
+                    float                   fMax;           // Maximum of the incomplete group of samples
+                } ch_peak_t;
+
+                typedef struct ch_snapshot_t
+                {
+                    float                  *vX;             // X coordinates of the inline display trace
+                    float                  *vY;             // Y coordinates of the inline display trace
+                    size_t                  nSize;          // Number of points in the trace
+                    size_t                  nSeq;           // Sequence number of the snapshot
+                    size_t                  nGen;           // Generation of the arena the X and Y buffers belong to
+                } ch_snapshot_t;
+
+                typedef struct ch_segment_t
+                {
+                    size_t                  nSize;          // Number of points in the segment
+                    wsize_t                 nTime;          // Trigger time, samples at the original sample rate
+                    float                   fTime;          // Trigger time relative to the first segment of the batch, seconds
+                    float                   fShift;         // Offset of the trigger event from the sweep sample grid, samples
+                } ch_segment_t;
+
                 typedef struct ch_state_stage_t
                 {
                     size_t  nPV_pScpMode;
@@ -142,6 +298,7 @@ namespace lsp
                     size_t  nPV_pSweepType;
 
                     float   fPV_pXYRecordTime;
+                    bool    bPV_pBaseTrigger;
                 } ch_state_stage_t;
 
                 typedef struct channel_t
@@ -152,6 +309,7 @@ namespace lsp
                     ch_coupling_t           enCoupling_x;
                     ch_coupling_t           enCoupling_y;
                     ch_coupling_t           enCoupling_ext;
+                    size_t                  nInputs;            // Mask of inputs used by the current settings
 
                     dspu::FilterBank        sDCBlockBank_x;
                     dspu::FilterBank        sDCBlockBank_y;
@@ -165,32 +323,75 @@ namespace lsp
                     dspu::Oversampler       sOversampler_y;
                     dspu::Oversampler       sOversampler_ext;
 
-                    dspu::Delay             sPreTrgDelay;
-
-                    dspu::Trigger           sTrigger;
+                    ch_trigger_t            sTrigger;
+                    bool                    bBaseTrigger;       // Trigger is searched at the original sample rate
+                    float                   fTrgLast;           // Last trigger input sample of the previous block
+                    float                   fSweepShift;        // Offset of the trigger event from the sweep sample grid, samples
+                    float                   fFrameShift;        // Offset of the sweep passed to the decimator, samples
 
                     dspu::Oscillator        sSweepGenerator;
 
-                    float                  *vTemp;
-                    float                  *vData_x;
-                    float                  *vData_y;
-                    float                  *vData_ext;
-                    float                  *vData_y_delay;
+                    float                  *vCapture;   // Circular buffer with oversampled (or original if bBaseTrigger) y data
+                    float                  *vSweep;     // Pre-computed x data of the sweep
                     float                  *vDisplay_x;
                     float                  *vDisplay_y;
-                    float                  *vDisplay_s; // Strobe
-
-                    float                  *vIDisplay_x;
-                    float                  *vIDisplay_y;
-                    size_t                  nIDisplay;
-
-                    size_t                  nDataHead;
+                    float                  *vFrame_x;   // Completed trace, decimated in background
+                    float                  *vFrame_y;
+                    size_t                  nFrameSize; // Number of points in the frame buffers
+                    uatomic_t               nFrameState;// State of the frame buffers, one of ch_frame_t
+
+                    float                  *vPhosphor;  // Hit histogram of the phosphor display, PHOSPHOR_ROWS x PHOSPHOR_COLS
+                    float                  *vSegments;  // Ring of segments, each segment takes X and Y planes of the size of the sweep table
+
+                    ch_segment_t            vSegment[meta::oscilloscope_metadata::SEGMENTS_MAX];
+                    size_t                  nSegHead;           // Index of the first captured segment in the ring
+                    size_t                  nSegCount;          // Number of captured segments not passed to the UI yet
+                    size_t                  nSegBatch;          // Number of first captured segments passed to the decimator
+                    uatomic_t               nSegState;          // State of the segment batch, one of ch_frame_t
+                    wsize_t                 nClock;             // Number of processed samples at the original sample rate
+                    wsize_t                 nTrgClock;          // Time of the last trigger event, samples
+
+                    float                  *vAverage;   // Averaged sweep
+                    float                   fAvgShift;          // Averaged offset of the trigger event from the sweep sample grid
+                    size_t                  nAvgCount;          // Number of sweeps accumulated in the average, up to nAverage
+                    size_t                  nAvgSweeps;         // Number of sweeps accumulated since the last published average
+
+                    float                  *vIDisplayBuf;       // X and Y buffers of three snapshots in the bound arena
+                    size_t                  nIDisplaySize;      // Size of each snapshot buffer
+                    ch_snapshot_t           vIDisplay[3];       // Triple buffer with inline display snapshots
+                    uatomic_t               nIDisplayLatest;    // Index of the latest published snapshot, with the IDISPLAY_FRESH flag
+                    size_t                  nIDisplayWrite;     // Index of the snapshot owned by the audio thread
+                    size_t                  nIDisplayRead;      // Index of the snapshot owned by the inline display
+                    size_t                  nIDisplaySeq;       // Sequence number of the last published snapshot
+                    size_t                  nIDisplayDrawn;     // Sequence number of the last drawn snapshot
+                    bool                    bIDisplayVisible;   // Visibility of the channel at the last inline display draw
+
+                    ch_buffers_t            sBufCapacity;       // Size of buffers bound to the channel
+                    ch_buffers_t            sBufRequest;        // Size of buffers required by current settings
+                    ch_buffers_t            sBufPending;        // Size of buffers being allocated by the arena allocator
+
+                    size_t                  nCaptureHead;       // Write position in the capture buffer
+                    size_t                  nDataHead;          // Read position in the capture buffer
                     size_t                  nDisplayHead;
+                    size_t                  nDisplaySent;       // Number of display points already submitted to the stream
+                    size_t                  nDisplayOut;        // Number of decimated display points already submitted to the stream
                     size_t                  nSamplesCounter;
+                    size_t                  nWarmUp;            // Number of oversampled samples to skip after resume
                     bool                    bClearStream;
+                    bool                    bSuspended;         // Channel is frozen or hidden, acquisition is not performed
+                    bool                    bSilent;            // All inputs used by the channel are silent
+                    bool                    bProgressive;       // Sweep is long enough to be submitted while it is being acquired
+                    bool                    bQueryDraw;         // Inline display needs to be redrawn after processing
+                    bool                    bResume;            // Acquisition is left by the worker to the audio thread
 
                     size_t                  nPreTrigger;
                     size_t                  nSweepSize;
+                    size_t                  nPeakDecim;         // Number of samples reduced to a min/max pair, 1 if samples are stored as is, 0 if oversampled
+                    size_t                  nPeakCounter;       // Number of samples in the incomplete group
+                    ch_peak_t               sPeak_y;            // Peak detector of the Y input
+                    ch_peak_t               sPeak_ext;          // Peak detector of the EXT input
+                    size_t                  nSweepSkip;         // Number of upsampled samples to skip before the sweep window
+                    size_t                  nSweepLeft;         // Number of samples to capture until the sweep window is complete
 
                     float                   fVerStreamScale;
                     float                   fVerStreamOffset;
@@ -253,21 +454,73 @@ namespace lsp
                     plug::IPort            *pMuteSwitch;
 
                     plug::IPort            *pStream;
+                    plug::IPort            *pFrameBuffer;       // Phosphor density image
                 } channel_t;
 
             protected:
                 dc_block_t          sDCBlockParams;
                 size_t              nChannels;
+                float               fSilence;       // Silence threshold, 0 if the silence gating is off
+                size_t              nMaxDots;       // Maximum number of dots in the trace
+                bool                bPhosphor;      // Sweeps are accumulated into the phosphor histogram
+                float               fPhosphorDecay; // Phosphor decay time, milliseconds
+                size_t              nPhosphorCounter;   // Number of samples since the last phosphor image
+                size_t              nSegments;      // Number of segments captured in the batch, 1 if the segmented acquisition is off
+                size_t              nSegmentCounter;    // Number of samples since the last batch of segments
+                ch_acquisition_t    enAcquisition;  // Acquisition mode of triggered sweeps
+                size_t              nAverage;       // Number of averaged sweeps
                 channel_t          *vChannels;
                 uint8_t            *pData;
 
+                // Scratch buffers, one set per processing thread
+                ch_scratch_t       *vScratch;
+                float              *vStrobe;        // Zero block used to fill the strobe column of the stream
+
+                // Parallel processing of channels
+                bool                bParallel;      // Channels are processed in parallel
+                size_t              nWorkers;       // Number of worker threads
+                ChannelWorker     **vWorkers;       // Worker threads
+                WorkerLauncher     *pLauncher;      // Starts worker threads in background
+                uint8_t            *pWorkerData;    // Scratch buffers of worker threads
+                bool                bWorkers;       // Worker threads have been started
+                ipc::Condition      sJobEvent;      // Wakes up workers when the job is published
+                size_t              nJobSamples;    // Number of samples to process by the current job
+                uatomic_t           nJobNext;       // Index of the next channel to process
+                uatomic_t           nJobDone;       // Number of processed channels
+                size_t              nJobHold;       // Number of samples to process serially after late workers
+
+                // Background decimation of completed traces
+                FrameDecimator     *pDecimator;
+                ipc::IExecutor     *pExecutor;      // Executor of background tasks, NULL if not available
+
+                // Display buffer arena
+                ArenaAllocator     *pArenaAllocator;
+                uint8_t            *pArena;         // Arena bound to the channels
+                uint8_t            *pArenaNew;      // Arena allocated in background but not bound yet
+                uint8_t            *pArenaGarbage;  // Previously bound arena, may still be accessed by the inline display
+                uint8_t            *pArenaRelease;  // Previously bound arena passed to the allocator for release
+                float              *vArenaNew;      // Aligned pointer to the data of the new arena
+                bool                bArenaAlloc;    // The allocator is requested to allocate the new arena
+                size_t              nArenaRetry;    // Number of samples to wait before the next allocation after failure
+                uatomic_t           nArenaGen;      // Generation of the bound arena, incremented on each re-bind
+
                 // Common Controls
                 plug::IPort        *pStrobeHistSize;
                 plug::IPort        *pXYRecordTime;
+                plug::IPort        *pMaxDots;
+                plug::IPort        *pSilenceGate;
+                plug::IPort        *pSilence;
+                plug::IPort        *pBaseTrigger;
+                plug::IPort        *pPhosphor;
+                plug::IPort        *pPhosphorDecay;
+                plug::IPort        *pSegments;
+                plug::IPort        *pAcquisition;
+                plug::IPort        *pAverage;
                 plug::IPort        *pFreeze;
 
                 // Channel Selector
                 plug::IPort        *pChannelSelector;
+                plug::IPort        *pParallel;
 
                 // Global ports:
                 plug::IPort        *pOvsMode;
@@ -293,6 +546,12 @@ namespace lsp
                 plug::IPort        *pTrgReset;
 
                 core::IDBuffer     *pIDisplay;      // Inline display buffer
+                uatomic_t           nIDisplayBusy;  // The inline display is accessing buffers of snapshots
+                size_t              nIDisplayWidth; // Width of the last drawn inline display
+                size_t              nIDisplayHeight;// Height of the last drawn inline display
+                uint8_t            *pIDisplayLayer; // Allocated data of the cached inline display background
+                uint8_t            *vIDisplayLayer; // Pixels of the cached inline display background
+                size_t              nIDisplayLayer; // Size of the cached background in bytes, 0 if not cached
 
             protected:
                 static dspu::over_mode_t   get_oversampler_mode(size_t portValue);
@@ -300,20 +559,60 @@ namespace lsp
                 static ch_sweep_type_t     get_sweep_type(size_t portValue);
                 static ch_trg_input_t      get_trigger_input(size_t portValue);
                 static ch_coupling_t       get_coupling_type(size_t portValue);
-                static dspu::trg_mode_t    get_trigger_mode(size_t portValue);
-                static dspu::trg_type_t    get_trigger_type(size_t portValue);
+                static ch_acquisition_t    get_acquisition_mode(size_t portValue);
+                static ch_trg_mode_t       get_trigger_mode(size_t portValue);
+                static ch_trg_type_t       get_trigger_type(size_t portValue);
+                static void                trigger_track(ch_trigger_t *t, const float *src, size_t count);
+                static size_t              trigger_search(ch_trigger_t *t, const float *src, size_t count);
+                static size_t              trigger_skip(ch_trigger_t *t, size_t count);
+                static size_t              peak_detect(float *dst, const float *src, size_t count, ch_peak_t *p, size_t decim, size_t counter);
 
             protected:
                 void                update_dc_block_filter(dspu::FilterBank &rFilterBank);
                 void                reconfigure_dc_block_filters();
-                void                do_sweep_step(channel_t *c, float strobe_value);
+                void                do_sweep(channel_t *c, size_t count);
+                void                do_window_sweep(channel_t *c, size_t tail, const ch_scratch_t *s);
+                void                start_window_sweep(channel_t *c, size_t offset, const float *trg_input, bool fired);
+                bool                acquire_base_rate(channel_t *c, size_t samples, bool silent, const ch_scratch_t *s);
                 float              *select_trigger_input(float *extPtr, float* yPtr, ch_trg_input_t input);
                 inline void         set_oversampler(dspu::Oversampler &over, dspu::over_mode_t mode);
                 inline void         set_sweep_generator(channel_t *c);
                 inline void         configure_oversamplers(channel_t *c, dspu::over_mode_t mode);
+                inline void         reset_oversampler(dspu::Oversampler &over, dspu::over_mode_t mode);
+                dspu::over_mode_t   select_oversampler_mode(const channel_t *c) const;
+                void                reset_inputs(channel_t *c, size_t inputs);
+                void                update_inputs(channel_t *c);
+                bool                is_silent(const channel_t *c, size_t samples) const;
+                void                suspend_channel(channel_t *c, size_t samples, const ch_scratch_t *s);
+                void                resume_channel(channel_t *c);
                 void                init_state_stage(channel_t *c);
                 void                commit_staged_state_change(channel_t *c);
-                bool                graph_stream(channel_t *c);
+                bool                graph_stream(channel_t *c, bool complete);
+                size_t              decimate_trace(const channel_t *c, float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count) const;
+                void                sweep_points(const channel_t *c, float *dst, size_t first, size_t count, float shift) const;
+                void                transform_trace(const channel_t *c, float *x, float *y, size_t count) const;
+                void                submit_trace(channel_t *c, plug::stream_t *stream, float *x, float *y, size_t count, bool strobe);
+                bool                accumulate_trace(channel_t *c, size_t first, size_t count, bool complete);
+                void                plot_phosphor(size_t samples);
+                bool                store_segment(channel_t *c);
+                void                queue_segments(size_t samples);
+                bool                plot_segments();
+                inline bool         is_averaging(const channel_t *c) const;
+                bool                average_trace(channel_t *c);
+                void                publish_snapshot(channel_t *c, const float *x, const float *y, size_t count);
+                static bool         fetch_snapshot(channel_t *c);
+                bool                complete_trace(channel_t *c);
+                status_t            decimate_frames();
+                bool                plot_frames();
+                bool                streams_directly(const channel_t *c) const;
+                static bool         may_complete(const channel_t *c, size_t points);
+                bool                acquire_channel(channel_t *c, const ch_scratch_t *s);
+                bool                process_channel(channel_t *c, size_t samples, const ch_scratch_t *s);
+                bool                process_channels(const ch_scratch_t *s);
+                status_t            allocate_arena();
+                void                bind_arena();
+                void                update_arena(size_t samples);
+                status_t            start_workers();
                 void                do_destroy();
 
             public:
@@ -79,7 +79,45 @@ This plugin implements a simple, but flexible, oscilloscope.
 	<li>
 	    <b>Max Dots</b> - This control, located at the bottom of the oscilloscope graph, allows the user to tune the amount of
 	    dots that are used to draw the traces on the oscilloscope graph. The higher number of dots can produce smoother traces, but
-	    at the expenses of UI load.
+	    at the expenses of UI load. In <b>Triggered</b> mode the sweep is reduced to the minimum and maximum values for each pair
+	    of dots, so short peaks of the signal remain visible on the trace.
+	</li>
+	<li>
+	    <b>Silence</b> - This button, located at the bottom of the oscilloscope graph, enables the silence gating and the
+	    nearby control sets the silence threshold. While the gating is enabled and the peak level of all inputs used by the
+	    channel stays below the threshold, the input is considered silent: the trigger does not fire and the channel draws
+	    a flat trace each time the auto-sweep period elapses. The gating is disabled by default so that low-level signals
+	    can be inspected with fine vertical divisions.
+	</li>
+	<li>
+	    <b>Base Rate Trigger</b> - This button, located at the bottom of the oscilloscope graph, makes the trigger search for
+	    events on the signal at the original sample rate. The position of the edge between samples is interpolated and only
+	    the part of the signal displayed by the sweep passes the oversampler, which significantly reduces CPU usage for
+	    high oversampling factors and sparse trigger events. Applies to the <b>Triggered</b> mode only.
+	</li>
+	<li>
+	    <b>Parallel</b> - This button is available for multichannel scopes on the bottom of the oscilloscope graph. When enabled,
+	    channels are processed by several threads which reduces processing time for large audio buffers.
+	</li>
+	<li>
+	    <b>Phosphor</b> - This button, located at the bottom of the oscilloscope graph, switches the graph to the phosphor mode.
+	    Instead of the trace line, the graph shows the intensity of the signal: the more often the trace passes through the
+	    point of the graph, the brighter the point is. Like the afterglow of the analog oscilloscope, the image fades out
+	    with the decay time set by the fader next to the button.
+	</li>
+	<li>
+	    <b>Segments</b> - This control, located at the bottom of the oscilloscope graph, enables the segmented acquisition when
+	    set to a value greater than 1. Up to the specified number of triggered sweeps are captured back to back into the segment
+	    memory and passed to the graph all at once several times per second. This allows to inspect rare events at short time
+	    divisions and reduces CPU usage when the trigger fires very often. Applies to the <b>Triggered</b> mode only.
+	</li>
+	<li>
+	    <b>Acquisition</b> - These controls, located at the bottom of the oscilloscope graph, select the acquisition mode and
+	    the number of sweeps to average. In the <b>Normal</b> mode each triggered sweep is passed to the graph as is. In the
+	    <b>Average</b> mode successive triggered sweeps are averaged and only the result is passed to the graph once per the
+	    specified number of sweeps. The average is running until the specified number of sweeps is collected and becomes
+	    exponential after that. This suppresses noise uncorrelated with the trigger and reduces CPU usage. Applies to the
+	    <b>Triggered</b> mode only.
 	</li>
 	<li>
 	    <b>H|V|T Labels</b> - These labels mirror the values of division chosen by the user on the main scopes settings -
@@ -112,6 +150,8 @@ This plugin implements a simple, but flexible, oscilloscope.
 	    <li><b>x4</b> - 4x downsampling.</li>
 	    <li><b>x6</b> - 6x downsampling.</li>
 	    <li><b>x8</b> - 8x downsampling.</li>
+	    <li><b>Auto</b> - the lowest factor that gives at least one sample per dot of the trace (see <b>Max Dots</b>) is
+	    selected depending on the <b>Time Division</b> (or <b>XY Sweep</b>) and the sample rate.</li>
     </ul>
     <li>
         <b>Mode</b> - This control sets the main oscilloscope mode. The following modes are available:
@@ -148,7 +188,11 @@ This plugin implements a simple, but flexible, oscilloscope.
         <li>
         	<b>Division</b> - In <b>Triggered</b> mode, this control sets the size, in milliseconds, of the horizontal division value
         	in the oscilloscope graph. In <b>XY</b> and <b>Goniometer</b> instead it controls, in units of amplitude, the horizontal
-        	division value in the oscilloscope graph.
+        	division value in the oscilloscope graph. When the sweep takes more than 100 milliseconds, the trace is drawn
+        	progressively while the signal is being acquired instead of being shown at the end of the sweep.
+        	For long time divisions that do not fit the sweep buffer, the oscilloscope stores the signal at the original sample rate
+        	without oversampling. If it still does not fit, the oscilloscope switches to peak detection: each group of samples is
+        	reduced to the pair of its minimum and maximum values, so the envelope of the signal is displayed.
         </li>
         <li>
         	<b>Position</b> - This trigger allows to introduce an horizontal shift in the trace. The shift is specified as a percentage
@@ -26,7 +26,7 @@
 
 #define LSP_PLUGINS_OSCILLOSCOPE_VERSION_MAJOR       1
 #define LSP_PLUGINS_OSCILLOSCOPE_VERSION_MINOR       0
-#define LSP_PLUGINS_OSCILLOSCOPE_VERSION_MICRO       30
+#define LSP_PLUGINS_OSCILLOSCOPE_VERSION_MICRO       31
 
 #define LSP_PLUGINS_OSCILLOSCOPE_VERSION  \
     LSP_MODULE_VERSION( \
@@ -50,6 +50,7 @@ namespace lsp
             {"4X",          "oscilloscope.oversampler.4x"},
             {"6X",          "oscilloscope.oversampler.6x"},
             {"8X",          "oscilloscope.oversampler.8x"},
+            {"Auto",        "oscilloscope.oversampler.auto"},
             {NULL,          NULL}
         };
 
@@ -117,6 +118,13 @@ namespace lsp
             {NULL,  NULL}
         };
 
+        static const port_item_t osc_acquisition[] =
+        {
+            {"Normal",  "oscilloscope.acquisition.normal"},
+            {"Average", "oscilloscope.acquisition.average"},
+            {NULL,      NULL}
+        };
+
         #define CHANNEL_AUDIO_PORTS(id, label) \
             AUDIO_INPUT("in_x" id, "Input x" label), \
             AUDIO_INPUT("in_y" id, "Input y" label), \
@@ -133,6 +141,20 @@ namespace lsp
         #define CHANNEL_SELECTOR(osc_channels) \
             COMBO("osc_cs", "Oscilloscope Channel Selector", "Chan selector", 0, osc_channels)
 
+        // Controls added after the first release follow all other ports to keep their indices
+        #define EXTRA_CONTROLS \
+            SWITCH("slgt", "Silence Gating", "Silence gate", 0.0f), \
+            LOG_CONTROL("slth", "Silence Threshold", "Silence thresh", U_GAIN_AMP, oscilloscope_metadata::SILENCE_THRESHOLD), \
+            SWITCH("trgbr", "Trigger At Base Sample Rate", "Base rate trg", 0.0f), \
+            SWITCH("phos", "Phosphor Display Mode", "Phosphor", 0.0f), \
+            LOG_CONTROL("phdc", "Phosphor Decay Time", "Ph decay", U_MSEC, oscilloscope_metadata::PHOSPHOR_DECAY), \
+            CONTROL("sgct", "Segment Count", "Segments", U_NONE, oscilloscope_metadata::SEGMENTS), \
+            COMBO("acqm", "Acquisition Mode", "Acquisition", oscilloscope_metadata::ACQUISITION_DFL, osc_acquisition), \
+            CONTROL("avgc", "Average Count", "Avg count", U_NONE, oscilloscope_metadata::AVERAGE_COUNT)
+
+        #define EXTRA_CHANNEL_CONTROLS \
+            SWITCH("mtpr", "Parallel Channel Processing", "Parallel", 0.0f)
+
         #define CHANNEL_SWITCHES(id, label) \
             SWITCH("glsw" id, "Global Switch" label, "Global " label, 0.0f), \
             SWITCH("frz" id, "Freeze Switch" label, "Freeze " label, 0.0f), \
@@ -177,12 +199,17 @@ namespace lsp
         #define OSC_VISUALOUTS(id, label) \
             STREAM("oscv" id, "Stream buffer" label, 3, 128, 0x8000)
 
+        #define EXTRA_VISUALOUTS(id, label) \
+            FBUFFER("oscp" id, "Phosphor frame buffer" label, oscilloscope_metadata::PHOSPHOR_ROWS, oscilloscope_metadata::PHOSPHOR_COLS)
+
         static const port_t oscilloscope_x1_ports[] =
         {
             CHANNEL_AUDIO_PORTS("_1", " 1"),
             COMMON_CONTROLS,
             CHANNEL_CONTROLS("_1", " 1", " 1"),
             OSC_VISUALOUTS("_1", " 1"),
+            EXTRA_CONTROLS,
+            EXTRA_VISUALOUTS("_1", " 1"),
             PORTS_END
         };
 
@@ -204,6 +231,12 @@ namespace lsp
             OSC_VISUALOUTS("_1", " 1"),
             OSC_VISUALOUTS("_2", " 2"),
 
+            EXTRA_CONTROLS,
+            EXTRA_CHANNEL_CONTROLS,
+
+            EXTRA_VISUALOUTS("_1", " 1"),
+            EXTRA_VISUALOUTS("_2", " 2"),
+
             PORTS_END
         };
 
@@ -233,6 +266,14 @@ namespace lsp
             OSC_VISUALOUTS("_3", " 3"),
             OSC_VISUALOUTS("_4", " 4"),
 
+            EXTRA_CONTROLS,
+            EXTRA_CHANNEL_CONTROLS,
+
+            EXTRA_VISUALOUTS("_1", " 1"),
+            EXTRA_VISUALOUTS("_2", " 2"),
+            EXTRA_VISUALOUTS("_3", " 3"),
+            EXTRA_VISUALOUTS("_4", " 4"),
+
             PORTS_END
         };
 
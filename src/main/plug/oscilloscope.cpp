@@ -22,14 +22,19 @@
 #include <private/plugins/oscilloscope.h>
 #include <lsp-plug.in/common/alloc.h>
 #include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/ipc/IExecutor.h>
 #include <lsp-plug.in/dsp/dsp.h>
 #include <lsp-plug.in/dsp-units/units.h>
 #include <lsp-plug.in/shared/debug.h>
 #include <lsp-plug.in/shared/id_colors.h>
 #include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
 
 #define BUF_LIM_SIZE        196608
-#define PRE_TRG_MAX_SIZE    196608
+#define BUF_BLOCK_SIZE      0x3000  /* Size of processing block, multiple of all oversampling factors */
+#define DISPLAY_BUF_GRANULE 0x600   /* Display buffers are allocated with this granularity, multiple of all oversampling factors */
+#define DISPLAY_BUFFERS     4       /* Number of display buffers per channel */
+#define TRG_SCAN_BLOCK      0x40    /* Block of samples checked at once by the trigger search */
 
 #define SWEEP_GEN_N_BITS    32
 #define SWEEP_GEN_PEAK      1.0f    /* Stream min x coordinate should be -SWEEP_GEN_PEAK and max x coordinate should be +SWEEP_GEN_PEAK */
@@ -45,8 +50,18 @@
 #define STREAM_N_HOR_DIV    4
 #define DECIM_PRECISION     0.1e-5  /* For development, this should be calculated from screen size */
 #define IDISPLAY_DECIM      0.2e-2  /* Decimation for inline display */
+#define IDISPLAY_POINTS     0x400   /* Maximum number of points in the inline display snapshot */
+#define IDISPLAY_INDEX      0x03    /* Mask of the snapshot index in the latest snapshot word */
+#define IDISPLAY_FRESH      0x04    /* The latest snapshot has not been fetched by the inline display yet */
 
 #define AUTO_SWEEP_TIME     1.0f
+#define ARENA_RETRY_TIME    1.0f    /* Delay before the next allocation of display buffers after failure, seconds */
+#define PARALLEL_MIN_SAMPLES 0x100  /* Shorter blocks are always processed serially */
+#define PARALLEL_SPIN_COUNT 0x1000  /* Number of checks of late workers before yielding */
+#define PARALLEL_HOLD_TIME  1.0f    /* Channels are processed serially for this time after late workers, seconds */
+#define PROGRESSIVE_TIME    0.1f    /* Sweeps longer than this (seconds) are submitted to the stream while being acquired */
+#define SEGMENTS_MEMORY_MAX 0x200000 /* Maximum number of samples in X and Y planes of all segments of the channel */
+#define UI_FRAME_RATE       25      /* Number of phosphor images and batches of segments passed to the UI per second */
 
 
 namespace lsp
@@ -87,8 +102,366 @@ namespace lsp
             }
 
             static plug::Factory factory(plugin_factory, plugins, 3);
+
+            static inline size_t display_buffer_size(size_t samples)
+            {
+                return align_size(samples, DISPLAY_BUF_GRANULE);
+            }
+
+            static inline size_t peak_points(size_t decim)
+            {
+                // Peak detection stores a min/max pair per group, single samples are stored as is
+                return (decim > 2) ? 2 : 1;
+            }
+
+            typedef struct transform_t
+            {
+                float   kxx, kxy;       // x' = kxx*x + kxy*y + bx
+                float   kyx, kyy;       // y' = kyx*x + kyy*y + by
+                float   bx, by;
+            } transform_t;
+
+            /**
+             * Apply affine transform to the set of points in one pass
+             *
+             * @param x X coordinates
+             * @param y Y coordinates
+             * @param t transform
+             * @param count number of points
+             */
+            static void transform_points(float *x, float *y, const transform_t *t, size_t count)
+            {
+                const float kxx = t->kxx, kxy = t->kxy, bx = t->bx;
+                const float kyx = t->kyx, kyy = t->kyy, by = t->by;
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    float vx        = x[i];
+                    float vy        = y[i];
+                    x[i]            = kxx*vx + kxy*vy + bx;
+                    y[i]            = kyx*vx + kyy*vy + by;
+                }
+            }
+
+            /**
+             * Accumulate points of the trace into the hit histogram. The histogram covers
+             * the whole stream area, the first row matches the top of the graph.
+             *
+             * @param dst hit histogram of PHOSPHOR_ROWS x PHOSPHOR_COLS cells
+             * @param x X coordinates of points in stream coordinates
+             * @param y Y coordinates of points in stream coordinates
+             * @param count number of points
+             */
+            static void accumulate_hits(float *dst, const float *x, const float *y, size_t count)
+            {
+                const ssize_t rows  = meta::oscilloscope_metadata::PHOSPHOR_ROWS;
+                const ssize_t cols  = meta::oscilloscope_metadata::PHOSPHOR_COLS;
+                const float kx      = cols / (STREAM_MAX_X - STREAM_MIN_X);
+                const float ky      = rows / (STREAM_MAX_Y - STREAM_MIN_Y);
+
+                for (size_t i=0; i<count; ++i)
+                {
+                    ssize_t col     = (x[i] - STREAM_MIN_X) * kx;
+                    ssize_t row     = (STREAM_MAX_Y - y[i]) * ky;
+                    if ((col < 0) || (col >= cols) || (row < 0) || (row >= rows))
+                        continue;
+                    dst[row * cols + col]  += 1.0f;
+                }
+            }
+
+            /**
+             * Decimate the trace: drop all points which are closer than the precision to the
+             * last kept point. The first point which carries the strobe is always kept.
+             * The decimation can be performed in-place.
+             *
+             * @param dst_x destination buffer for X coordinates
+             * @param dst_y destination buffer for Y coordinates
+             * @param src_x source X coordinates
+             * @param src_y source Y coordinates
+             * @param count number of source points
+             * @param precision squared minimum distance between two points
+             * @return number of kept points
+             */
+            static size_t decimate(
+                float *dst_x, float *dst_y,
+                const float *src_x, const float *src_y,
+                size_t count, float precision)
+            {
+                if (count <= 0)
+                    return 0;
+
+                // Each point is checked against the last kept one, so the loop can not be split
+                // into independent blocks: the well-predicted branch is faster than block checks,
+                // see the oscilloscope.decimate performance test
+                float rx        = src_x[0];
+                float ry        = src_y[0];
+                size_t j        = 0;
+
+                dst_x[0]        = rx;
+                dst_y[0]        = ry;
+
+                for (size_t i = 1; i < count; ++i)
+                {
+                    float dx        = src_x[i] - rx;
+                    float dy        = src_y[i] - ry;
+                    if ((dx*dx + dy*dy) < precision) // Skip point
+                        continue;
+
+                    // Keep the point
+                    ++j;
+                    rx              = src_x[i];
+                    ry              = src_y[i];
+                    dst_x[j]        = rx;
+                    dst_y[j]        = ry;
+                }
+
+                return j + 1;
+            }
+
+            /**
+             * Decimate the trace to the set of columns: each run of consecutive points that fall
+             * into the same column is replaced by the points with minimum and maximum Y coordinate
+             * in the order they appear in the run. This keeps narrow peaks visible on the trace.
+             * The first point which carries the strobe is always kept. The decimation can be
+             * performed in-place.
+             *
+             * @param dst_x destination buffer for X coordinates
+             * @param dst_y destination buffer for Y coordinates
+             * @param src_x source X coordinates
+             * @param src_y source Y coordinates
+             * @param count number of source points
+             * @param xmin the X coordinate of the left side of the first column
+             * @param xmax the X coordinate of the right side of the last column
+             * @param columns number of columns
+             * @return number of kept points
+             */
+            static size_t decimate_columns(
+                float *dst_x, float *dst_y,
+                const float *src_x, const float *src_y,
+                size_t count, float xmin, float xmax, size_t columns)
+            {
+                const float kx      = columns / (xmax - xmin);
+                const ssize_t last  = columns - 1;
+                if (count <= 0)
+                    return 0;
+
+                // Keep the first point
+                dst_x[0]            = src_x[0];
+                dst_y[0]            = src_y[0];
+                size_t j            = 1;
+
+                for (size_t i = 1; i < count; )
+                {
+                    // Find the end of the run
+                    ssize_t col         = lsp_limit(ssize_t((src_x[i] - xmin) * kx), ssize_t(0), last);
+                    size_t end          = i + 1;
+                    while ((end < count) && (lsp_limit(ssize_t((src_x[end] - xmin) * kx), ssize_t(0), last) == col))
+                        ++end;
+
+                    size_t len          = end - i;
+                    if (len <= 1)
+                    {
+                        dst_x[j]            = src_x[i];
+                        dst_y[j++]          = src_y[i];
+                    }
+                    else
+                    {
+                        size_t imin, imax;
+                        dsp::minmax_index(&src_y[i], len, &imin, &imax);
+                        size_t first        = i + lsp_min(imin, imax);
+                        size_t second       = i + lsp_max(imin, imax);
+                        if (first == second)
+                            second              = end - 1;
+
+                        float x1 = src_x[first], y1 = src_y[first];
+                        float x2 = src_x[second], y2 = src_y[second];
+                        dst_x[j]            = x1;
+                        dst_y[j++]          = y1;
+                        dst_x[j]            = x2;
+                        dst_y[j++]          = y2;
+                    }
+
+                    i                   = end;
+                }
+
+                return j;
+            }
+
+            /**
+             * Reduce the trace to the limited number of points: the trace is split into groups
+             * of consecutive points and each group is replaced by the points with minimum and
+             * maximum Y coordinate in the order they appear in the group. Short traces are
+             * copied as is.
+             *
+             * @param dst_x destination buffer for X coordinates
+             * @param dst_y destination buffer for Y coordinates
+             * @param src_x source X coordinates
+             * @param src_y source Y coordinates
+             * @param count number of source points
+             * @param limit maximum number of points, should be even
+             * @return number of kept points
+             */
+            static size_t reduce_points(
+                float *dst_x, float *dst_y,
+                const float *src_x, const float *src_y,
+                size_t count, size_t limit)
+            {
+                if (count <= limit)
+                {
+                    dsp::copy(dst_x, src_x, count);
+                    dsp::copy(dst_y, src_y, count);
+                    return count;
+                }
+
+                const size_t groups = limit >> 1;
+                size_t j            = 0;
+                for (size_t g = 0; g < groups; ++g)
+                {
+                    size_t first        = (g * count) / groups;
+                    size_t last         = ((g + 1) * count) / groups;
+                    size_t imin, imax;
+                    dsp::minmax_index(&src_y[first], last - first, &imin, &imax);
+
+                    size_t a            = first + lsp_min(imin, imax);
+                    size_t b            = first + lsp_max(imin, imax);
+                    dst_x[j]            = src_x[a];
+                    dst_y[j++]          = src_y[a];
+                    if (a != b)
+                    {
+                        dst_x[j]            = src_x[b];
+                        dst_y[j++]          = src_y[b];
+                    }
+                }
+
+                return j;
+            }
+
+            /**
+             * Find the first sample below (or above) the level. Each block of samples is
+             * checked at once with the vectorized reduction and only the block which
+             * contains the matching sample is looked through sample by sample.
+             *
+             * @param src source buffer
+             * @param count number of samples in the buffer
+             * @param level the level
+             * @param below look for the sample below the level, otherwise above the level
+             * @param inclusive the sample equal to the level also matches
+             * @return index of the matching sample or count if there is no such sample
+             */
+            static size_t find_crossing(const float *src, size_t count, float level, bool below, bool inclusive)
+            {
+                for (size_t i = 0; i < count; )
+                {
+                    size_t to_do    = lsp_min(count - i, size_t(TRG_SCAN_BLOCK));
+                    const float *p  = &src[i];
+
+                    if (below)
+                    {
+                        float v         = dsp::min(p, to_do);
+                        if ((v < level) || ((inclusive) && (v <= level)))
+                        {
+                            for (size_t j=0; j<to_do; ++j)
+                                if ((p[j] < level) || ((inclusive) && (p[j] <= level)))
+                                    return i + j;
+                        }
+                    }
+                    else
+                    {
+                        float v         = dsp::max(p, to_do);
+                        if ((v > level) || ((inclusive) && (v >= level)))
+                        {
+                            for (size_t j=0; j<to_do; ++j)
+                                if ((p[j] > level) || ((inclusive) && (p[j] >= level)))
+                                    return i + j;
+                        }
+                    }
+
+                    i              += to_do;
+                }
+
+                return count;
+            }
         } /* inline namespace */
 
+        //-------------------------------------------------------------------------
+        oscilloscope::ArenaAllocator::ArenaAllocator(oscilloscope *core)
+        {
+            pCore       = core;
+        }
+
+        oscilloscope::ArenaAllocator::~ArenaAllocator()
+        {
+            pCore       = NULL;
+        }
+
+        status_t oscilloscope::ArenaAllocator::run()
+        {
+            return pCore->allocate_arena();
+        }
+
+        //-------------------------------------------------------------------------
+        oscilloscope::ChannelWorker::ChannelWorker(oscilloscope *core, const ch_scratch_t *scratch)
+        {
+            pCore       = core;
+            pScratch    = scratch;
+        }
+
+        oscilloscope::ChannelWorker::~ChannelWorker()
+        {
+            pCore       = NULL;
+            pScratch    = NULL;
+        }
+
+        status_t oscilloscope::ChannelWorker::run()
+        {
+            // The audio thread never waits for sleeping workers, it takes channels not claimed by them
+            ipc::Condition *event = &pCore->sJobEvent;
+            while (!is_cancelled())
+            {
+                if (pCore->process_channels(pScratch))
+                    continue;
+
+                event->lock();
+                if ((!is_cancelled()) && (atomic_load(&pCore->nJobNext) >= pCore->nChannels))
+                    event->wait();
+                event->unlock();
+            }
+
+            return STATUS_OK;
+        }
+
+        //-------------------------------------------------------------------------
+        oscilloscope::FrameDecimator::FrameDecimator(oscilloscope *core)
+        {
+            pCore       = core;
+        }
+
+        oscilloscope::FrameDecimator::~FrameDecimator()
+        {
+            pCore       = NULL;
+        }
+
+        status_t oscilloscope::FrameDecimator::run()
+        {
+            return pCore->decimate_frames();
+        }
+
+        //-------------------------------------------------------------------------
+        oscilloscope::WorkerLauncher::WorkerLauncher(oscilloscope *core)
+        {
+            pCore       = core;
+        }
+
+        oscilloscope::WorkerLauncher::~WorkerLauncher()
+        {
+            pCore       = NULL;
+        }
+
+        status_t oscilloscope::WorkerLauncher::run()
+        {
+            return pCore->start_workers();
+        }
+
         //-------------------------------------------------------------------------
         oscilloscope::oscilloscope(const meta::plugin_t *metadata, size_t channels): plug::Module(metadata)
         {
@@ -97,14 +470,60 @@ namespace lsp
 
             nChannels           = channels;
             vChannels           = NULL;
+            fSilence            = 0.0f;
+            nMaxDots            = 0;
+            bPhosphor           = false;
+            fPhosphorDecay      = meta::oscilloscope_metadata::PHOSPHOR_DECAY_DFL;
+            nPhosphorCounter    = 0;
+            nSegments           = 1;
+            nSegmentCounter     = 0;
+            enAcquisition       = CH_ACQUISITION_DFL;
+            nAverage            = meta::oscilloscope_metadata::AVERAGE_COUNT_DFL;
 
             pData               = NULL;
 
+            vScratch            = NULL;
+            vStrobe             = NULL;
+
+            bParallel           = false;
+            nWorkers            = 0;
+            vWorkers            = NULL;
+            pLauncher           = NULL;
+            pWorkerData         = NULL;
+            bWorkers            = false;
+            nJobSamples         = 0;
+            nJobNext            = 0;
+            nJobDone            = 0;
+            nJobHold            = 0;
+
+            pDecimator          = NULL;
+            pExecutor           = NULL;
+
+            pArenaAllocator     = NULL;
+            pArena              = NULL;
+            pArenaNew           = NULL;
+            pArenaGarbage       = NULL;
+            pArenaRelease       = NULL;
+            vArenaNew           = NULL;
+            bArenaAlloc         = false;
+            nArenaRetry         = 0;
+            nArenaGen           = 0;
+
             pStrobeHistSize     = NULL;
             pXYRecordTime       = NULL;
+            pMaxDots            = NULL;
+            pSilenceGate        = NULL;
+            pSilence            = NULL;
+            pBaseTrigger        = NULL;
+            pPhosphor           = NULL;
+            pPhosphorDecay      = NULL;
+            pSegments           = NULL;
+            pAcquisition        = NULL;
+            pAverage            = NULL;
             pFreeze             = NULL;
 
             pChannelSelector    = NULL;
+            pParallel           = NULL;
 
             pOvsMode            = NULL;
             pScpMode            = NULL;
@@ -129,6 +548,12 @@ namespace lsp
             pTrgReset           = NULL;
 
             pIDisplay           = NULL;
+            nIDisplayBusy       = 0;
+            nIDisplayWidth      = 0;
+            nIDisplayHeight     = 0;
+            pIDisplayLayer      = NULL;
+            vIDisplayLayer      = NULL;
+            nIDisplayLayer      = 0;
         }
 
         oscilloscope::~oscilloscope()
@@ -144,9 +569,72 @@ namespace lsp
 
         void oscilloscope::do_destroy()
         {
+            // Stop workers before releasing the data they use
+            if (vWorkers != NULL)
+            {
+                for (size_t i = 0; i < nWorkers; ++i)
+                {
+                    if (vWorkers[i] != NULL)
+                        vWorkers[i]->cancel();
+                }
+
+                // Wake up sleeping workers to let them leave
+                sJobEvent.lock();
+                sJobEvent.notify_all();
+                sJobEvent.unlock();
+
+                for (size_t i = 0; i < nWorkers; ++i)
+                {
+                    ChannelWorker *w = vWorkers[i];
+                    if (w == NULL)
+                        continue;
+                    w->join();
+                    delete w;
+                }
+                delete [] vWorkers;
+                vWorkers        = NULL;
+            }
+            nWorkers            = 0;
+            bWorkers            = false;
+
+            if (pLauncher != NULL)
+            {
+                delete pLauncher;
+                pLauncher       = NULL;
+            }
+
+            if (vScratch != NULL)
+            {
+                delete [] vScratch;
+                vScratch        = NULL;
+            }
+
+            free_aligned(pWorkerData);
+            pWorkerData = NULL;
+
             free_aligned(pData);
             pData = NULL;
 
+            vStrobe             = NULL;
+
+            if (pDecimator != NULL)
+            {
+                delete pDecimator;
+                pDecimator      = NULL;
+            }
+
+            if (pArenaAllocator != NULL)
+            {
+                delete pArenaAllocator;
+                pArenaAllocator = NULL;
+            }
+
+            free_aligned(pArena);
+            free_aligned(pArenaNew);
+            free_aligned(pArenaGarbage);
+            free_aligned(pArenaRelease);
+            vArenaNew = NULL;
+
             if (vChannels != NULL)
             {
                 for (size_t ch = 0; ch < nChannels; ++ch)
@@ -161,21 +649,24 @@ namespace lsp
                     c->sOversampler_y.destroy();
                     c->sOversampler_ext.destroy();
 
-                    c->sPreTrgDelay.destroy();
-
                     c->sSweepGenerator.destroy();
 
-                    c->vTemp            = NULL;
-                    c->vData_x          = NULL;
-                    c->vData_y          = NULL;
-                    c->vData_ext        = NULL;
-                    c->vData_y_delay    = NULL;
+                    c->vCapture         = NULL;
+                    c->vSweep           = NULL;
                     c->vDisplay_x       = NULL;
                     c->vDisplay_y       = NULL;
-                    c->vDisplay_s       = NULL;
-
-                    c->vIDisplay_x      = NULL;
-                    c->vIDisplay_y      = NULL;
+                    c->vFrame_x         = NULL;
+                    c->vFrame_y         = NULL;
+                    c->vPhosphor        = NULL;
+                    c->vSegments        = NULL;
+                    c->vAverage         = NULL;
+                    c->vIDisplayBuf     = NULL;
+
+                    for (size_t i=0; i<3; ++i)
+                    {
+                        c->vIDisplay[i].vX  = NULL;
+                        c->vIDisplay[i].vY  = NULL;
+                    }
                 }
 
                 delete [] vChannels;
@@ -187,6 +678,10 @@ namespace lsp
                 pIDisplay->destroy();
                 pIDisplay   = NULL;
             }
+
+            free_aligned(pIDisplayLayer);
+            vIDisplayLayer      = NULL;
+            nIDisplayLayer      = 0;
         }
 
         void oscilloscope::init(plug::IWrapper *wrapper, plug::IPort **ports)
@@ -197,21 +692,41 @@ namespace lsp
             if (vChannels == NULL)
                 return;
 
-            /** For each channel:
+            pArenaAllocator = new ArenaAllocator(this);
+            if (pArenaAllocator == NULL)
+                return;
+
+            pDecimator      = new FrameDecimator(this);
+            if (pDecimator == NULL)
+                return;
+
+            // Multi-channel versions may process channels in parallel, one worker per extra channel
+            nWorkers        = nChannels - 1;
+            vScratch        = new ch_scratch_t[nWorkers + 1];
+            if (vScratch == NULL)
+                return;
+
+            if (nWorkers > 0)
+            {
+                pLauncher       = new WorkerLauncher(this);
+                if (pLauncher == NULL)
+                    return;
+            }
+
+            /** Each processing thread has its own set of scratch buffers:
              * 1X temp buffer +
              * 1X external data buffer +
              * 1X x data buffer +
-             * 1X y data buffer +
-             * 1X delayed y data buffer +
-             * 1X x display buffer +
-             * 1X y display buffer +
-             * 1X strobe display buffer
-             * 1X x inline display buffer
-             * 1X y inline display buffer
+             * 1X y data buffer
+             * The strobe buffer is shared:
+             * 1X strobe buffer
              *
-             * All buffers size BUF_LIM_SIZE
+             * All buffers size BUF_BLOCK_SIZE. Only buffers of the audio thread are
+             * allocated here, buffers of workers are allocated by start_workers().
+             * Display buffers depend on the actual settings of each channel and are
+             * allocated in the arena, see allocate_arena().
              */
-            size_t samples = nChannels * BUF_LIM_SIZE * 10;
+            size_t samples = BUF_BLOCK_SIZE * (4 + 1);
 
             float *ptr = alloc_aligned<float>(pData, samples);
             if (ptr == NULL)
@@ -219,6 +734,24 @@ namespace lsp
 
             lsp_guard_assert(float *save = ptr);
 
+            for (size_t i = 0; i <= nWorkers; ++i)
+            {
+                ch_scratch_t *s         = &vScratch[i];
+                s->vTemp                = NULL;
+                s->vData_x              = NULL;
+                s->vData_y              = NULL;
+                s->vData_ext            = NULL;
+                s->bAudio               = (i == 0);
+            }
+
+            ch_scratch_t *s         = &vScratch[0];
+            s->vTemp                = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+            s->vData_x              = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+            s->vData_y              = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+            s->vData_ext            = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+            vStrobe                 = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+            dsp::fill_zero(vStrobe, BUF_BLOCK_SIZE);
+
             for (size_t ch = 0; ch < nChannels; ++ch)
             {
                 channel_t *c = &vChannels[ch];
@@ -243,8 +776,21 @@ namespace lsp
                 if (!c->sOversampler_ext.init())
                     return;
 
-                if (!c->sPreTrgDelay.init(PRE_TRG_MAX_SIZE))
-                    return;
+                // Settings for the Trigger
+                c->sTrigger.enMode          = CH_TRG_MODE_REPEAT;
+                c->sTrigger.enType          = CH_TRG_TYPE_NONE;
+                c->sTrigger.fArmLevel       = 0.0f;
+                c->sTrigger.fFireLevel      = 0.0f;
+                c->sTrigger.nHold           = 0;
+                c->sTrigger.nHoldCounter    = 0;
+                c->sTrigger.bRising         = true;
+                c->sTrigger.bArmed          = false;
+                c->sTrigger.bSingleLock     = false;
+                c->sTrigger.bManualAllow    = false;
+                c->bBaseTrigger             = false;
+                c->fTrgLast                 = 0.0f;
+                c->fSweepShift              = 0.0f;
+                c->fFrameShift              = 0.0f;
 
                 // Settings for the Sweep Generator
                 c->sSweepGenerator.init();
@@ -252,26 +798,96 @@ namespace lsp
                 c->sSweepGenerator.set_phase(0.0f);
                 c->sSweepGenerator.update_settings();
 
-                c->vTemp                = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vData_x              = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vData_y              = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vData_ext            = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vData_y_delay        = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vDisplay_x           = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vDisplay_y           = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vDisplay_s           = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vIDisplay_x          = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-                c->vIDisplay_y          = advance_ptr<float>(ptr, BUF_LIM_SIZE);
-
-                c->nIDisplay            = 0;
-
+                c->vCapture             = NULL;
+                c->vSweep               = NULL;
+                c->vDisplay_x           = NULL;
+                c->vDisplay_y           = NULL;
+                c->vFrame_x             = NULL;
+                c->vFrame_y             = NULL;
+                c->nFrameSize           = 0;
+                c->nFrameState          = CH_FRAME_NONE;
+                c->vPhosphor            = NULL;
+                c->vSegments            = NULL;
+                for (size_t i=0; i<meta::oscilloscope_metadata::SEGMENTS_MAX; ++i)
+                {
+                    c->vSegment[i].nSize    = 0;
+                    c->vSegment[i].nTime    = 0;
+                    c->vSegment[i].fTime    = 0.0f;
+                    c->vSegment[i].fShift   = 0.0f;
+                }
+                c->nSegHead             = 0;
+                c->nSegCount            = 0;
+                c->nSegBatch            = 0;
+                c->nSegState            = CH_FRAME_NONE;
+                c->nClock               = 0;
+                c->nTrgClock            = 0;
+                c->vAverage             = NULL;
+                c->fAvgShift            = 0.0f;
+                c->nAvgCount            = 0;
+                c->nAvgSweeps           = 0;
+                c->vIDisplayBuf         = NULL;
+                c->nIDisplaySize        = 0;
+                for (size_t i=0; i<3; ++i)
+                {
+                    ch_snapshot_t *sn       = &c->vIDisplay[i];
+                    sn->vX                  = NULL;
+                    sn->vY                  = NULL;
+                    sn->nSize               = 0;
+                    sn->nSeq                = 0;
+                    sn->nGen                = 0;
+                }
+                c->nIDisplayWrite       = 0;
+                c->nIDisplayLatest      = 1;
+                c->nIDisplayRead        = 2;
+                c->nIDisplaySeq         = 0;
+                c->nIDisplayDrawn       = 0;
+                c->bIDisplayVisible     = false;
+
+                c->nInputs              = 0;
+
+                c->sBufCapacity.nDisplay    = 0;
+                c->sBufCapacity.nCapture    = 0;
+                c->sBufCapacity.nSweep      = 0;
+                c->sBufRequest.nDisplay     = 0;
+                c->sBufRequest.nCapture     = 0;
+                c->sBufRequest.nSweep       = 0;
+                c->sBufPending.nDisplay     = 0;
+                c->sBufPending.nCapture     = 0;
+                c->sBufPending.nSweep       = 0;
+                c->sBufCapacity.nPhosphor   = 0;
+                c->sBufRequest.nPhosphor    = 0;
+                c->sBufPending.nPhosphor    = 0;
+                c->sBufCapacity.nSegments   = 0;
+                c->sBufRequest.nSegments    = 0;
+                c->sBufPending.nSegments    = 0;
+                c->sBufCapacity.nAverage    = 0;
+                c->sBufRequest.nAverage     = 0;
+                c->sBufPending.nAverage     = 0;
+
+                c->nCaptureHead         = 0;
                 c->nDataHead            = 0;
                 c->nDisplayHead         = 0;
+                c->nDisplaySent         = 0;
+                c->nDisplayOut          = 0;
                 c->nSamplesCounter      = 0;
+                c->nWarmUp              = 0;
                 c->bClearStream         = false;
+                c->bSuspended           = false;
+                c->bSilent              = false;
+                c->bProgressive         = false;
+                c->bQueryDraw           = false;
+                c->bResume              = false;
 
                 c->nPreTrigger          = 0;
                 c->nSweepSize           = 0;
+                c->nPeakDecim           = 0;
+                c->nPeakCounter         = 0;
+                c->sPeak_y.fMin         = 0.0f;
+                c->sPeak_y.fMax         = 0.0f;
+                c->sPeak_ext.fMin       = 0.0f;
+                c->sPeak_ext.fMax       = 0.0f;
+                c->nSweepSkip           = 0;
+                c->nSweepLeft           = 0;
 
                 c->fVerStreamScale      = 0.0f;
                 c->fVerStreamOffset     = 0.0f;
@@ -323,6 +939,7 @@ namespace lsp
                 c->pMuteSwitch          = NULL;
 
                 c->pStream              = NULL;
+                c->pFrameBuffer         = NULL;
             }
 
             lsp_assert(ptr <= &save[samples]);
@@ -348,7 +965,7 @@ namespace lsp
 
             BIND_PORT(pStrobeHistSize);
             BIND_PORT(pXYRecordTime);
-            SKIP_PORT("maxdots parameter");
+            BIND_PORT(pMaxDots);
             BIND_PORT(pFreeze);
 
             // Global ports only exists on multi-channel versions. Skip for 1X plugin.
@@ -422,6 +1039,101 @@ namespace lsp
                 channel_t *c        = &vChannels[ch];
                 BIND_PORT(c->pStream);
             }
+
+            // Controls added after the first release follow all other ports
+            lsp_trace("Binding extra control ports");
+            BIND_PORT(pSilenceGate);
+            BIND_PORT(pSilence);
+            BIND_PORT(pBaseTrigger);
+            BIND_PORT(pPhosphor);
+            BIND_PORT(pPhosphorDecay);
+            BIND_PORT(pSegments);
+            BIND_PORT(pAcquisition);
+            BIND_PORT(pAverage);
+            if (nChannels > 1)
+                BIND_PORT(pParallel);
+
+            lsp_trace("Binding extra visual outputs ports");
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+                BIND_PORT(c->pFrameBuffer);
+            }
+
+            // Without the executor the arena can not be re-allocated in background, allocate buffers
+            // for the longest sweep, the phosphor display and the average at once. Segments need
+            // the executor since their size depends on the sweep size.
+            ipc::IExecutor *executor = (wrapper != NULL) ? wrapper->executor() : NULL;
+            if (executor == NULL)
+            {
+                for (size_t ch = 0; ch < nChannels; ++ch)
+                {
+                    channel_t *c                = &vChannels[ch];
+                    c->sBufPending.nDisplay     = display_buffer_size(BUF_LIM_SIZE);
+                    c->sBufPending.nCapture     = c->sBufPending.nDisplay + BUF_BLOCK_SIZE;
+                    c->sBufPending.nSweep       = c->sBufPending.nDisplay;
+                    c->sBufPending.nPhosphor    = meta::oscilloscope_metadata::PHOSPHOR_ROWS * meta::oscilloscope_metadata::PHOSPHOR_COLS;
+                    c->sBufPending.nSegments    = 0;
+                    c->sBufPending.nAverage     = c->sBufPending.nDisplay;
+                }
+
+                bArenaAlloc     = true;
+                if (allocate_arena() == STATUS_OK)
+                    bind_arena();
+                bArenaAlloc     = false;
+            }
+
+            // Workers are started in background when the parallel processing is enabled for the first time,
+            // the job counter is set to prevent them from taking channels
+            nJobNext        = nChannels;
+            nJobDone        = nChannels;
+            if (nWorkers > 0)
+            {
+                vWorkers        = new ChannelWorker *[nWorkers];
+                if (vWorkers == NULL)
+                {
+                    nWorkers        = 0;
+                    return;
+                }
+
+                for (size_t i = 0; i < nWorkers; ++i)
+                    vWorkers[i]     = NULL;
+            }
+        }
+
+        status_t oscilloscope::start_workers()
+        {
+            if (vWorkers == NULL)
+                return STATUS_OK;
+
+            // Allocate scratch buffers of workers, see init()
+            size_t samples  = BUF_BLOCK_SIZE * 4 * nWorkers;
+            float *ptr      = alloc_aligned<float>(pWorkerData, samples);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+
+            for (size_t i = 1; i <= nWorkers; ++i)
+            {
+                ch_scratch_t *s         = &vScratch[i];
+                s->vTemp                = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+                s->vData_x              = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+                s->vData_y              = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+                s->vData_ext            = advance_ptr<float>(ptr, BUF_BLOCK_SIZE);
+            }
+
+            // Failed workers are not restarted since the audio thread processes
+            // channels not taken by workers itself
+            for (size_t i = 0; i < nWorkers; ++i)
+            {
+                vWorkers[i]     = new ChannelWorker(this, &vScratch[i + 1]);
+                if ((vWorkers[i] != NULL) && (vWorkers[i]->start() != STATUS_OK))
+                {
+                    delete vWorkers[i];
+                    vWorkers[i]     = NULL;
+                }
+            }
+
+            return STATUS_OK;
         }
 
         dspu::over_mode_t oscilloscope::get_oversampler_mode(size_t portValue)
@@ -501,75 +1213,241 @@ namespace lsp
             }
         }
 
-        dspu::trg_mode_t oscilloscope::get_trigger_mode(size_t portValue)
+        oscilloscope::ch_acquisition_t oscilloscope::get_acquisition_mode(size_t portValue)
+        {
+            switch (portValue)
+            {
+                case meta::oscilloscope_metadata::ACQUISITION_NORMAL:
+                    return CH_ACQUISITION_NORMAL;
+                case meta::oscilloscope_metadata::ACQUISITION_AVERAGE:
+                    return CH_ACQUISITION_AVERAGE;
+                default:
+                    return CH_ACQUISITION_DFL;
+            }
+        }
+
+        oscilloscope::ch_trg_mode_t oscilloscope::get_trigger_mode(size_t portValue)
         {
             switch (portValue)
             {
                 case meta::oscilloscope_metadata::TRIGGER_MODE_SINGLE:
-                    return dspu::TRG_MODE_SINGLE;
+                    return CH_TRG_MODE_SINGLE;
                 case  meta::oscilloscope_metadata::TRIGGER_MODE_MANUAL:
-                    return dspu::TRG_MODE_MANUAL;
+                    return CH_TRG_MODE_MANUAL;
                 case meta::oscilloscope_metadata::TRIGGER_MODE_REPEAT:
-                    return dspu::TRG_MODE_REPEAT;
+                    return CH_TRG_MODE_REPEAT;
                 default:
-                    return dspu::TRG_MODE_REPEAT;
+                    return CH_TRG_MODE_REPEAT;
             }
         }
 
-        dspu::trg_type_t oscilloscope::get_trigger_type(size_t portValue)
+        oscilloscope::ch_trg_type_t oscilloscope::get_trigger_type(size_t portValue)
         {
             switch (portValue)
             {
                 case meta::oscilloscope_metadata::TRIGGER_TYPE_NONE:
-                    return dspu::TRG_TYPE_NONE;
+                    return CH_TRG_TYPE_NONE;
                 case meta::oscilloscope_metadata::TRIGGER_TYPE_SIMPLE_RISING_EDGE:
-                    return dspu::TRG_TYPE_SIMPLE_RISING_EDGE;
+                    return CH_TRG_TYPE_SIMPLE_RISING_EDGE;
                 case meta::oscilloscope_metadata::TRIGGER_TYPE_SIMPE_FALLING_EDGE:
-                    return dspu::TRG_TYPE_SIMPLE_FALLING_EDGE;
+                    return CH_TRG_TYPE_SIMPLE_FALLING_EDGE;
                 case meta::oscilloscope_metadata::TRIGGER_TYPE_ADVANCED_RISING_EDGE:
-                    return dspu::TRG_TYPE_ADVANCED_RISING_EDGE;
+                    return CH_TRG_TYPE_ADVANCED_RISING_EDGE;
                 case meta::oscilloscope_metadata::TRIGGER_TYPE_ADVANCED_FALLING_EDGE:
-                    return dspu::TRG_TYPE_ADVANCED_FALLING_EDGE;
+                    return CH_TRG_TYPE_ADVANCED_FALLING_EDGE;
                 default:
-                    return dspu::TRG_TYPE_NONE;
+                    return CH_TRG_TYPE_NONE;
             }
         }
 
-        void oscilloscope::update_dc_block_filter(dspu::FilterBank &rFilterBank)
+        void oscilloscope::trigger_track(ch_trigger_t *t, const float *src, size_t count)
         {
-            /* Filter Transfer Function:
-             *
-             *          g - g z^-1
-             * H(z) = ----------------
-             *          1 - a * z^-1
-             *
-             * With g = sDCBlockParams.fGain, a = sACBlockParams.fAlpha
-             */
-
-            rFilterBank.begin();
-
-            dsp::biquad_x1_t *f = rFilterBank.add_chain();
-            if (f == NULL)
+            if (t->enType == CH_TRG_TYPE_NONE)
                 return;
 
-            f->b0   = sDCBlockParams.fGain;
-            f->b1   = -sDCBlockParams.fGain;
-            f->b2   = 0.0f;
-            f->a1   = sDCBlockParams.fAlpha;
-            f->a2   = 0.0f;
-            f->p0   = 0.0f;
-            f->p1   = 0.0f;
-            f->p2   = 0.0f;
-
-            rFilterBank.end(true);
-        }
-
-        void oscilloscope::reconfigure_dc_block_filters()
-        {
-            double omega = 2.0 * M_PI * DC_BLOCK_CUTOFF_HZ / fSampleRate; // Normalised frequency
+            // The arming state is defined by the last sample that crossed the arm or the fire level.
+            // Look for the block containing such sample starting from the end of the buffer.
+            while (count > 0)
+            {
+                size_t to_do    = lsp_min(count, size_t(TRG_SCAN_BLOCK));
+                const float *p  = &src[count - to_do];
+                float vmin, vmax;
+                dsp::minmax(p, to_do, &vmin, &vmax);
 
-            double c = cos(omega);
-            double g = 1.9952623149688795; // This is 10^(3/10), used to calculate the parameter alpha so that it is exactly associated to the cutoff frequency (-3 dB).
+                if (t->bRising)
+                {
+                    if ((vmin < t->fArmLevel) || (vmax >= t->fFireLevel))
+                    {
+                        for (ssize_t j=to_do-1; j >= 0; --j)
+                        {
+                            if (p[j] < t->fArmLevel)
+                            {
+                                t->bArmed       = true;
+                                return;
+                            }
+                            if (p[j] >= t->fFireLevel)
+                            {
+                                t->bArmed       = false;
+                                return;
+                            }
+                        }
+                    }
+                }
+                else
+                {
+                    if ((vmax > t->fArmLevel) || (vmin <= t->fFireLevel))
+                    {
+                        for (ssize_t j=to_do-1; j >= 0; --j)
+                        {
+                            if (p[j] > t->fArmLevel)
+                            {
+                                t->bArmed       = true;
+                                return;
+                            }
+                            if (p[j] <= t->fFireLevel)
+                            {
+                                t->bArmed       = false;
+                                return;
+                            }
+                        }
+                    }
+                }
+
+                count          -= to_do;
+            }
+        }
+
+        size_t oscilloscope::trigger_search(ch_trigger_t *t, const float *src, size_t count)
+        {
+            for (size_t n = 0; n < count; )
+            {
+                size_t left     = count - n;
+
+                // Check that the trigger is allowed to fire
+                bool locked     = (t->enType == CH_TRG_TYPE_NONE);
+                if (t->enMode == CH_TRG_MODE_SINGLE)
+                    locked          = locked || t->bSingleLock;
+                else if (t->enMode == CH_TRG_MODE_MANUAL)
+                    locked          = locked || (!t->bManualAllow);
+
+                // Samples that can not cause the trigger to fire only affect the arming state
+                size_t hold     = (locked) ? left :
+                                  (t->nHoldCounter < t->nHold) ? lsp_min(left, t->nHold - t->nHoldCounter) : 0;
+                if (hold > 0)
+                {
+                    trigger_track(t, &src[n], hold);
+                    t->nHoldCounter = lsp_min(t->nHoldCounter + hold, t->nHold);
+                    n              += hold;
+                    continue;
+                }
+
+                // Arm the trigger first
+                if (!t->bArmed)
+                {
+                    size_t off      = find_crossing(&src[n], left, t->fArmLevel, t->bRising, false);
+                    if (off >= left)
+                        return count;
+
+                    // The sample that has armed the trigger can not fire it
+                    t->bArmed       = true;
+                    n              += off + 1;
+                    continue;
+                }
+
+                // Now look for the fire
+                size_t off      = find_crossing(&src[n], left, t->fFireLevel, !t->bRising, true);
+                if (off >= left)
+                    return count;
+
+                t->bArmed       = false;
+                t->nHoldCounter = lsp_min(size_t(1), t->nHold);
+                if (t->enMode == CH_TRG_MODE_SINGLE)
+                    t->bSingleLock  = true;
+                else if (t->enMode == CH_TRG_MODE_MANUAL)
+                    t->bManualAllow = false;
+
+                return n + off;
+            }
+
+            return count;
+        }
+
+        size_t oscilloscope::trigger_skip(ch_trigger_t *t, size_t count)
+        {
+            // The trigger does not fire on silence, only the hold time elapses
+            t->nHoldCounter     = lsp_min(t->nHoldCounter + count, t->nHold);
+            return count;
+        }
+
+        size_t oscilloscope::peak_detect(float *dst, const float *src, size_t count, ch_peak_t *p, size_t decim, size_t counter)
+        {
+            // Samples at the original sample rate are stored without reduction
+            if (decim <= 1)
+            {
+                dsp::copy(dst, src, count);
+                return count;
+            }
+
+            size_t points = 0;
+
+            for (size_t n = 0; n < count; )
+            {
+                size_t to_do    = lsp_min(count - n, decim - counter);
+                float vmin, vmax;
+                dsp::minmax(&src[n], to_do, &vmin, &vmax);
+
+                p->fMin         = (counter > 0) ? lsp_min(p->fMin, vmin) : vmin;
+                p->fMax         = (counter > 0) ? lsp_max(p->fMax, vmax) : vmax;
+                counter        += to_do;
+                n              += to_do;
+
+                // Each complete group of samples is stored as a pair of points
+                if (counter >= decim)
+                {
+                    dst[points++]   = p->fMin;
+                    dst[points++]   = p->fMax;
+                    counter         = 0;
+                }
+            }
+
+            return points;
+        }
+
+        void oscilloscope::update_dc_block_filter(dspu::FilterBank &rFilterBank)
+        {
+            /* Filter Transfer Function:
+             *
+             *          g - g z^-1
+             * H(z) = ----------------
+             *          1 - a * z^-1
+             *
+             * With g = sDCBlockParams.fGain, a = sACBlockParams.fAlpha
+             */
+
+            rFilterBank.begin();
+
+            dsp::biquad_x1_t *f = rFilterBank.add_chain();
+            if (f == NULL)
+                return;
+
+            f->b0   = sDCBlockParams.fGain;
+            f->b1   = -sDCBlockParams.fGain;
+            f->b2   = 0.0f;
+            f->a1   = sDCBlockParams.fAlpha;
+            f->a2   = 0.0f;
+            f->p0   = 0.0f;
+            f->p1   = 0.0f;
+            f->p2   = 0.0f;
+
+            rFilterBank.end(true);
+        }
+
+        void oscilloscope::reconfigure_dc_block_filters()
+        {
+            double omega = 2.0 * M_PI * DC_BLOCK_CUTOFF_HZ / fSampleRate; // Normalised frequency
+
+            double c = cos(omega);
+            double g = 1.9952623149688795; // This is 10^(3/10), used to calculate the parameter alpha so that it is exactly associated to the cutoff frequency (-3 dB).
             double r = sqrt(c*c - 1.0 - 2.0 * g * c + 2.0 * g);
 
             double alpha1 = c + r;
@@ -594,13 +1472,189 @@ namespace lsp
             }
         }
 
-        void oscilloscope::do_sweep_step(channel_t *c, float strobe_value)
+        void oscilloscope::do_sweep(channel_t *c, size_t count)
         {
-            c->sSweepGenerator.process_overwrite(&c->vDisplay_x[c->nDisplayHead], 1);
-            c->vDisplay_y[c->nDisplayHead] = c->vData_y_delay[c->nDataHead];
-            c->vDisplay_s[c->nDisplayHead] = strobe_value;
-            ++c->nDataHead;
-            ++c->nDisplayHead;
+            float *dst_y    = &c->vDisplay_y[c->nDisplayHead];
+
+            // X coordinates are taken from the sweep table while plotting,
+            // copy data from the capture buffer, it may wrap around once
+            size_t to_copy  = lsp_min(count, c->sBufCapacity.nCapture - c->nDataHead);
+            dsp::copy(dst_y, &c->vCapture[c->nDataHead], to_copy);
+            if (to_copy < count)
+            {
+                dsp::copy(&dst_y[to_copy], c->vCapture, count - to_copy);
+                c->nDataHead    = count - to_copy;
+            }
+            else
+                c->nDataHead   += to_copy;
+            if (c->nDataHead >= c->sBufCapacity.nCapture)
+                c->nDataHead    = 0;
+
+            c->nDisplayHead    += count;
+        }
+
+        void oscilloscope::do_window_sweep(channel_t *c, size_t tail, const ch_scratch_t *s)
+        {
+            // Upsample the captured data up to the tail position, it may wrap around
+            while ((c->nDataHead != tail) && (c->nDisplayHead < c->nSweepSize))
+            {
+                size_t limit    = (tail > c->nDataHead) ? tail : c->sBufCapacity.nCapture;
+                size_t to_do    = lsp_min(limit - c->nDataHead, size_t(BUF_BLOCK_SIZE) / c->nOversampling);
+                size_t produced = to_do * c->nOversampling;
+
+                c->sOversampler_y.upsample(s->vData_y, &c->vCapture[c->nDataHead], to_do);
+                c->nDataHead   += to_do;
+                if (c->nDataHead >= c->sBufCapacity.nCapture)
+                    c->nDataHead    = 0;
+
+                // Drop the filter warm-up and the samples before the window
+                size_t skip     = lsp_min(c->nSweepSkip, produced);
+                size_t count    = lsp_min(produced - skip, c->nSweepSize - c->nDisplayHead);
+                c->nSweepSkip  -= skip;
+
+                dsp::copy(&c->vDisplay_y[c->nDisplayHead], &s->vData_y[skip], count);
+                c->nDisplayHead    += count;
+            }
+        }
+
+        void oscilloscope::start_window_sweep(channel_t *c, size_t offset, const float *trg_input, bool fired)
+        {
+            // Find the position of the edge between samples
+            float frac          = 1.0f;
+            if (fired)
+            {
+                float prev          = (offset > 0) ? trg_input[offset - 1] : c->fTrgLast;
+                float curr          = trg_input[offset];
+                if (curr != prev)
+                    frac                = lsp_limit((c->sTrigger.fFireLevel - prev) / (curr - prev), 0.0f, 1.0f);
+            }
+
+            // Position of the window start at the oversampled rate relative to the capture head
+            ssize_t ovs         = c->nOversampling;
+            ssize_t latency     = c->sOversampler_y.latency();
+            ssize_t pos         = ssize_t((ssize_t(offset) - 1 + frac) * ovs + 0.5f) - ssize_t(c->nPreTrigger);
+            ssize_t first       = (pos >= 0) ? pos / ovs : -((ovs - 1 - pos) / ovs);
+            ssize_t last        = first + (pos - first * ovs + c->nSweepSize + ovs - 1) / ovs + latency;
+
+            // The upsampler needs the history of the filter and produces the output with latency
+            ssize_t cap         = c->sBufCapacity.nCapture;
+            c->nDataHead        = (c->nCaptureHead + cap + first - latency) % cap;
+            c->nSweepSkip       = pos - first * ovs + 2 * latency * ovs;
+            c->nSweepLeft       = lsp_max(last - ssize_t(offset) - 1, ssize_t(0));
+
+            reset_oversampler(c->sOversampler_y, c->enOverMode);
+            c->nTrgClock        = c->nClock + offset;
+
+            // The window start is rounded to the oversampled sample, the sweep compensates the rounding error
+            c->fSweepShift      = float(pos + ssize_t(c->nPreTrigger)) - (ssize_t(offset) - 1 + frac) * ovs;
+        }
+
+        bool oscilloscope::acquire_base_rate(channel_t *c, size_t samples, bool silent, const ch_scratch_t *s)
+        {
+            bool query_draw     = false;
+
+            // Data is captured at the original sample rate
+            float *data_y       = &c->vCapture[c->nCaptureHead];
+            if (silent)
+                dsp::fill_zero(data_y, samples);
+            else if (c->enCoupling_y == CH_COUPLING_AC)
+                c->sDCBlockBank_y.process(data_y, c->vIn_y, samples);
+            else
+                dsp::copy(data_y, c->vIn_y, samples);
+
+            // EXT input is processed only when it drives the trigger
+            if (silent)
+                dsp::fill_zero(s->vData_ext, samples);
+            else if (c->nInputs & CH_INPUT_EXT)
+            {
+                if (c->enCoupling_ext == CH_COUPLING_AC)
+                    c->sDCBlockBank_ext.process(s->vData_ext, c->vIn_ext, samples);
+                else
+                    dsp::copy(s->vData_ext, c->vIn_ext, samples);
+            }
+
+            const float *trg_input = select_trigger_input(s->vData_ext, data_y, c->enTrgInput);
+
+            for (size_t n = 0; n < samples; )
+            {
+                size_t left = samples - n;
+
+                switch (c->enState)
+                {
+                    case CH_STATE_LISTENING:
+                    {
+                        // Do not search for the trigger beyond the auto-sweep position
+                        size_t count = left;
+                        if (c->bAutoSweep)
+                            count       = lsp_min(count, (c->nAutoSweepCounter < c->nAutoSweepLimit) ? c->nAutoSweepLimit - c->nAutoSweepCounter + 1 : 1);
+
+                        size_t off  = (silent) ?
+                            trigger_skip(&c->sTrigger, count) :
+                            trigger_search(&c->sTrigger, &trg_input[n], count);
+                        bool fired  = off < count;
+                        if (!fired)
+                        {
+                            // No sweep triggered?
+                            if ((!c->bAutoSweep) || (c->nAutoSweepCounter + count <= c->nAutoSweepLimit))
+                            {
+                                if (c->bAutoSweep)
+                                    c->nAutoSweepCounter   += count;
+                                n          += count;
+                                break;
+                            }
+                            off         = count - 1;
+                        }
+
+                        n          += off;
+                        start_window_sweep(c, n, trg_input, fired);
+                        n          += 1;
+
+                        c->enState              = CH_STATE_SWEEPING;
+                        c->nAutoSweepCounter    = 0;
+                        c->nDisplayHead         = 0;
+                        c->nDisplaySent         = 0;
+                        c->nDisplayOut          = 0;
+                        break;
+                    }
+
+                    case CH_STATE_SWEEPING:
+                    {
+                        // The trigger keeps tracking the signal, but fires are discarded while sweeping
+                        size_t count = lsp_min(left, c->nSweepLeft);
+                        if (silent)
+                            trigger_skip(&c->sTrigger, count);
+                        else
+                        {
+                            for (size_t k = 0; k < count; ++k)
+                                k          += trigger_search(&c->sTrigger, &trg_input[n + k], count - k);
+                        }
+
+                        n                  += count;
+                        c->nSweepLeft      -= count;
+
+                        // Only the captured window passes the upsampler
+                        do_window_sweep(c, (c->nCaptureHead + n) % c->sBufCapacity.nCapture, s);
+
+                        if ((c->nSweepLeft == 0) || (c->nDisplayHead >= c->nSweepSize))
+                        {
+                            // Plot time!
+                            if (complete_trace(c))
+                                query_draw      = true;
+                            c->enState      = CH_STATE_LISTENING;
+                        }
+                        break;
+                    }
+                }
+            }
+
+            c->fTrgLast         = trg_input[samples - 1];
+
+            // Update the capture buffer write position
+            c->nCaptureHead    += samples;
+            if (c->nCaptureHead >= c->sBufCapacity.nCapture)
+                c->nCaptureHead     = 0;
+
+            return query_draw;
         }
 
         float *oscilloscope::select_trigger_input(float *extPtr, float* yPtr, ch_trg_input_t input)
@@ -626,7 +1680,7 @@ namespace lsp
         void oscilloscope::set_sweep_generator(channel_t *c)
         {
             c->sSweepGenerator.set_sample_rate(c->nOverSampleRate);
-            c->sSweepGenerator.set_frequency(c->nOverSampleRate / c->nSweepSize);
+            c->sSweepGenerator.set_frequency(c->nOverSampleRate / lsp_max(c->nSweepSize, size_t(1)));
 
             switch (c->enSweepType)
             {
@@ -664,6 +1718,140 @@ namespace lsp
             c->sSweepGenerator.update_settings();
         }
 
+        void oscilloscope::reset_oversampler(dspu::Oversampler &over, dspu::over_mode_t mode)
+        {
+            // Switching the mode forces the oversampler to drop the filter history
+            over.set_mode(dspu::OM_NONE);
+            over.set_mode(mode);
+            over.update_settings();
+        }
+
+        dspu::over_mode_t oscilloscope::select_oversampler_mode(const channel_t *c) const
+        {
+            static const dspu::over_mode_t modes[] =
+            {
+                dspu::OM_NONE,
+                dspu::OM_LANCZOS_2X24BIT,
+                dspu::OM_LANCZOS_3X24BIT,
+                dspu::OM_LANCZOS_4X24BIT,
+                dspu::OM_LANCZOS_6X24BIT,
+                dspu::OM_LANCZOS_8X24BIT
+            };
+            static const size_t factors[] = { 1, 2, 3, 4, 6, 8 };
+            static const size_t n_modes = sizeof(factors) / sizeof(size_t);
+
+            // Number of samples of the trace at the original sample rate
+            size_t length   = (c->enMode == CH_MODE_TRIGGERED) ?
+                STREAM_N_HOR_DIV * dspu::millis_to_samples(fSampleRate, c->sStateStage.fPV_pTimeDiv) :
+                dspu::millis_to_samples(fSampleRate, c->sStateStage.fPV_pXYRecordTime);
+
+            // Use the lowest factor that gives at least one sample per dot but does not overflow the buffers
+            size_t i        = 0;
+            while ((i < n_modes - 1) && (length * factors[i] < nMaxDots) && (length * factors[i + 1] <= BUF_LIM_SIZE))
+                ++i;
+
+            return modes[i];
+        }
+
+        void oscilloscope::update_inputs(channel_t *c)
+        {
+            size_t inputs       = CH_INPUT_Y;
+            if (c->enMode == CH_MODE_TRIGGERED)
+            {
+                if (c->enTrgInput == CH_TRG_INPUT_EXT)
+                    inputs             |= CH_INPUT_EXT;
+            }
+            else
+                inputs             |= CH_INPUT_X;
+
+            // Inputs that come back into use should not keep the outdated filter history
+            size_t enabled      = inputs & (~c->nInputs);
+            c->nInputs          = inputs;
+
+            reset_inputs(c, enabled);
+        }
+
+        void oscilloscope::reset_inputs(channel_t *c, size_t inputs)
+        {
+            if (inputs & CH_INPUT_X)
+            {
+                c->sDCBlockBank_x.reset();
+                reset_oversampler(c->sOversampler_x, c->enOverMode);
+            }
+            if (inputs & CH_INPUT_Y)
+            {
+                c->sDCBlockBank_y.reset();
+                reset_oversampler(c->sOversampler_y, c->enOverMode);
+            }
+            if (inputs & CH_INPUT_EXT)
+            {
+                c->sDCBlockBank_ext.reset();
+                reset_oversampler(c->sOversampler_ext, c->enOverMode);
+            }
+        }
+
+        bool oscilloscope::is_silent(const channel_t *c, size_t samples) const
+        {
+            if (fSilence <= 0.0f)
+                return false;
+
+            if ((c->nInputs & CH_INPUT_X) && (dsp::abs_max(c->vIn_x, samples) >= fSilence))
+                return false;
+            if ((c->nInputs & CH_INPUT_Y) && (dsp::abs_max(c->vIn_y, samples) >= fSilence))
+                return false;
+            if ((c->nInputs & CH_INPUT_EXT) && (dsp::abs_max(c->vIn_ext, samples) >= fSilence))
+                return false;
+
+            return true;
+        }
+
+        void oscilloscope::suspend_channel(channel_t *c, size_t samples, const ch_scratch_t *s)
+        {
+            c->bSuspended       = true;
+
+            // Keep DC blocking filters running since they take long time to settle
+            for (size_t offset = 0; offset < samples; )
+            {
+                size_t to_do        = lsp_min(samples - offset, size_t(BUF_BLOCK_SIZE));
+
+                if ((c->nInputs & CH_INPUT_X) && (c->enCoupling_x == CH_COUPLING_AC))
+                    c->sDCBlockBank_x.process(s->vTemp, &c->vIn_x[offset], to_do);
+                if ((c->nInputs & CH_INPUT_Y) && (c->enCoupling_y == CH_COUPLING_AC))
+                    c->sDCBlockBank_y.process(s->vTemp, &c->vIn_y[offset], to_do);
+                if ((c->nInputs & CH_INPUT_EXT) && (c->enCoupling_ext == CH_COUPLING_AC))
+                    c->sDCBlockBank_ext.process(s->vTemp, &c->vIn_ext[offset], to_do);
+
+                offset             += to_do;
+            }
+        }
+
+        void oscilloscope::resume_channel(channel_t *c)
+        {
+            c->bSuspended       = false;
+
+            // Drop the outdated oversampler history
+            if (c->nInputs & CH_INPUT_X)
+                reset_oversampler(c->sOversampler_x, c->enOverMode);
+            if (c->nInputs & CH_INPUT_Y)
+                reset_oversampler(c->sOversampler_y, c->enOverMode);
+            if (c->nInputs & CH_INPUT_EXT)
+                reset_oversampler(c->sOversampler_ext, c->enOverMode);
+
+            // Drop the captured data and the incomplete sweep
+            c->nCaptureHead     = 0;
+            c->nDataHead        = 0;
+            c->nPeakCounter     = 0;
+            c->nDisplayHead     = 0;
+            c->nDisplaySent     = 0;
+            c->nDisplayOut      = 0;
+            c->enState          = CH_STATE_LISTENING;
+            if (c->vCapture != NULL)
+                dsp::fill_zero(c->vCapture, c->sBufCapacity.nCapture);
+
+            // Samples produced by the oversampler before its history is filled are not displayed
+            c->nWarmUp          = c->sOversampler_y.latency() * c->nOversampling;
+        }
+
         void oscilloscope::configure_oversamplers(channel_t *c, dspu::over_mode_t mode)
         {
             c->enOverMode = mode;
@@ -734,6 +1922,9 @@ namespace lsp
             c->sStateStage.fPV_pXYRecordTime = meta::oscilloscope_metadata::XY_RECORD_TIME_DFL;
             c->nUpdate |= UPD_XY_RECORD_TIME;
 
+            c->sStateStage.bPV_pBaseTrigger = false;
+            c->nUpdate |= UPD_TRIGGER_RATE;
+
             c->nUpdate |= UPD_VER_SCALES;
             c->nUpdate |= UPD_HOR_SCALES;
 
@@ -752,6 +1943,12 @@ namespace lsp
             {
                 c->enMode           = get_scope_mode(c->sStateStage.nPV_pScpMode);
                 c->nDisplayHead     = 0;    // Reset the display head
+                c->nDisplaySent     = 0;
+                c->nDisplayOut      = 0;
+                c->nUpdate         |= UPD_OVERSAMPLER_Y; // Captured history is outdated
+
+                // Display buffers are sized depending on the mode, re-evaluate them
+                c->nUpdate         |= UPD_XY_RECORD_TIME | UPD_PRETRG_DELAY | UPD_SWEEP_GENERATOR | UPD_TRIGGER_HOLD;
             }
 
             if (c->nUpdate & UPD_ACBLOCK_X)
@@ -763,28 +1960,93 @@ namespace lsp
             if (c->nUpdate & UPD_ACBLOCK_EXT)
                 c->enCoupling_ext = get_coupling_type(c->sStateStage.nPV_pCoupling_ext);
 
+            if (c->nUpdate & UPD_TRIGGER_RATE)
+                c->bBaseTrigger = c->sStateStage.bPV_pBaseTrigger;
+
+            // Automatic oversampling depends on the length of the trace, reconfigure only if the factor changes
+            dspu::over_mode_t over_mode = get_oversampler_mode(c->sStateStage.nPV_pOvsMode);
+            if (c->sStateStage.nPV_pOvsMode == meta::oscilloscope_metadata::OSC_OVS_AUTO)
+            {
+                over_mode   = select_oversampler_mode(c);
+                if ((c->nUpdate & (UPD_OVERSAMPLER_AUTO | UPD_SWEEP_GENERATOR | UPD_XY_RECORD_TIME)) && (over_mode != c->enOverMode))
+                    c->nUpdate |= UPD_OVERSAMPLER_X | UPD_OVERSAMPLER_Y | UPD_OVERSAMPLER_EXT |
+                                  UPD_PRETRG_DELAY | UPD_SWEEP_GENERATOR | UPD_TRIGGER_HOLD |
+                                  UPD_XY_RECORD_TIME;
+            }
+
             if (c->nUpdate & (UPD_OVERSAMPLER_X | UPD_OVERSAMPLER_Y | UPD_OVERSAMPLER_EXT))
-                configure_oversamplers(c, get_oversampler_mode(c->sStateStage.nPV_pOvsMode));
+            {
+                configure_oversamplers(c, over_mode);
+
+                // Captured history does not match the new sample rate
+                c->nCaptureHead     = 0;
+                c->nDataHead        = 0;
+                if (c->vCapture != NULL)
+                    dsp::fill_zero(c->vCapture, c->sBufCapacity.nCapture);
+            }
 
             if (c->nUpdate & UPD_XY_RECORD_TIME)
             {
                 c->nXYRecordSize = dspu::millis_to_samples(c->nOverSampleRate, c->sStateStage.fPV_pXYRecordTime);
                 c->nXYRecordSize = (c->nXYRecordSize < BUF_LIM_SIZE) ? c->nXYRecordSize  : BUF_LIM_SIZE;
+
+                // Request buffers of proper size and use as much as currently available
+                if (c->enMode != CH_MODE_TRIGGERED)
+                {
+                    c->sBufRequest.nDisplay = display_buffer_size(c->nXYRecordSize);
+                    c->sBufRequest.nCapture = 0;
+                    c->sBufRequest.nSweep   = 0;
+                }
+                c->nXYRecordSize = lsp_min(c->nXYRecordSize, c->sBufCapacity.nDisplay);
             }
 
             // UPD_SWEEP_GENERATOR handling is split because if also UPD_PRETRG_DELAY needs to be handled them the correct order of operations is as follows.
             if (c->nUpdate & UPD_SWEEP_GENERATOR)
             {
                 c->nSweepSize = STREAM_N_HOR_DIV * dspu::millis_to_samples(c->nOverSampleRate, c->sStateStage.fPV_pTimeDiv);
+
+                // Too long sweeps store samples at the original sample rate if they fit the buffer,
+                // otherwise minimum and maximum of each group of more than two samples
+                size_t decim    = 0;
+                if (c->nSweepSize > BUF_LIM_SIZE)
+                {
+                    size_t length   = STREAM_N_HOR_DIV * dspu::millis_to_samples(fSampleRate, c->sStateStage.fPV_pTimeDiv);
+                    decim           = (length > BUF_LIM_SIZE) ? (2 * length + BUF_LIM_SIZE - 1) / BUF_LIM_SIZE : 1;
+                    c->nSweepSize   = peak_points(decim) * ((length + decim - 1) / decim);
+                }
                 c->nSweepSize = (c->nSweepSize < BUF_LIM_SIZE) ? c->nSweepSize  : BUF_LIM_SIZE;
+
+                // Captured history does not match the new acquisition rate
+                if (decim != c->nPeakDecim)
+                {
+                    c->nPeakDecim       = decim;
+                    c->nPeakCounter     = 0;
+                    c->nCaptureHead     = 0;
+                    c->nDataHead        = 0;
+                    if (c->vCapture != NULL)
+                        dsp::fill_zero(c->vCapture, c->sBufCapacity.nCapture);
+                }
+
+                // Request buffers of proper size and use as much as currently available.
+                // The capture buffer should keep pre-trigger history and one processing block.
+                if (c->enMode == CH_MODE_TRIGGERED)
+                {
+                    c->sBufRequest.nDisplay = display_buffer_size(c->nSweepSize);
+                    c->sBufRequest.nCapture = c->sBufRequest.nDisplay + BUF_BLOCK_SIZE;
+                    c->sBufRequest.nSweep   = c->sBufRequest.nDisplay;
+                }
+                size_t capture  = (c->sBufCapacity.nCapture > BUF_BLOCK_SIZE) ? c->sBufCapacity.nCapture - BUF_BLOCK_SIZE : 0;
+                c->nSweepSize   = lsp_min(c->nSweepSize, lsp_min(c->sBufCapacity.nSweep, capture));
+
+                // Captured segments and the average do not match the new sweep
+                c->nSegCount    = 0;
+                c->nAvgCount    = 0;
+                c->nAvgSweeps   = 0;
             }
 
             if (c->nUpdate & UPD_PRETRG_DELAY)
             {
-                c->nPreTrigger = 0.5f * (0.01f * c->sStateStage.fPV_pHorPos  + 1) * (c->nSweepSize - 1);
-                c->nPreTrigger = (c->nPreTrigger < PRE_TRG_MAX_SIZE) ? c->nPreTrigger : PRE_TRG_MAX_SIZE;
-                c->sPreTrgDelay.set_delay(c->nPreTrigger);
-                c->sPreTrgDelay.clear();
+                c->nPreTrigger = (c->nSweepSize > 0) ? 0.5f * (0.01f * c->sStateStage.fPV_pHorPos  + 1) * (c->nSweepSize - 1) : 0;
             }
 
             if (c->nUpdate & UPD_SWEEP_GENERATOR)
@@ -792,6 +2054,16 @@ namespace lsp
                 c->enSweepType = get_sweep_type(c->sStateStage.nPV_pSweepType);
                 set_sweep_generator(c);
 
+                // The sweep depends only on the sweep type and size, compute it once
+                if (c->vSweep != NULL)
+                {
+                    c->sSweepGenerator.reset_phase_accumulator();
+                    c->sSweepGenerator.process_overwrite(c->vSweep, c->nSweepSize);
+                }
+
+                // Long sweeps are drawn progressively instead of waiting for the whole period
+                c->bProgressive = (c->nPeakDecim > 0) || (c->nSweepSize > dspu::seconds_to_samples(c->nOverSampleRate, PROGRESSIVE_TIME));
+
                 // Since the seep period has changed, we need to revert state to LISTENING.
                 c->enState = CH_STATE_LISTENING;
             }
@@ -801,14 +2073,25 @@ namespace lsp
 
             if (c->nUpdate & UPD_TRIGGER_HOLD)
             {
+                // In the peak detection mode the trigger counts stored points instead of samples
+                float rate     = (c->nPeakDecim > 0) ? float(peak_points(c->nPeakDecim) * fSampleRate) / c->nPeakDecim : c->nOverSampleRate;
                 size_t minHold = c->nSweepSize;
-                size_t trgHold = dspu::seconds_to_samples(c->nOverSampleRate, c->sStateStage.fPV_pTrgHold);
+                size_t trgHold = dspu::seconds_to_samples(rate, c->sStateStage.fPV_pTrgHold);
                 trgHold = trgHold > minHold ? trgHold : minHold;
-                c->sTrigger.set_trigger_hold_samples(trgHold);
+                c->sTrigger.nHold       = trgHold;
+                c->sTrigger.nHoldCounter= lsp_min(c->sTrigger.nHoldCounter, trgHold);
 
-                c->nAutoSweepLimit      = dspu::seconds_to_samples(c->nOverSampleRate, AUTO_SWEEP_TIME);
+                c->nAutoSweepLimit      = dspu::seconds_to_samples(rate, AUTO_SWEEP_TIME);
                 c->nAutoSweepLimit      = (c->nAutoSweepLimit < trgHold) ? trgHold: c->nAutoSweepLimit;
                 c->nAutoSweepCounter    = 0;
+
+                // The trigger counts samples at the original sample rate
+                if ((c->bBaseTrigger) && (c->nPeakDecim == 0))
+                {
+                    c->sTrigger.nHold       = (c->sTrigger.nHold + c->nOversampling - 1) / c->nOversampling;
+                    c->sTrigger.nHoldCounter= lsp_min(c->sTrigger.nHoldCounter, c->sTrigger.nHold);
+                    c->nAutoSweepLimit      = (c->nAutoSweepLimit + c->nOversampling - 1) / c->nOversampling;
+                }
             }
 
             if (c->nUpdate & UPD_HOR_SCALES)
@@ -825,33 +2108,398 @@ namespace lsp
 
             if (c->nUpdate & UPD_TRIGGER)
             {
-                dspu::trg_mode_t trgMode= get_trigger_mode(c->sStateStage.nPV_pTrgMode);
+                ch_trg_mode_t trgMode   = get_trigger_mode(c->sStateStage.nPV_pTrgMode);
 
-                c->bAutoSweep           = !((trgMode == dspu::TRG_MODE_SINGLE) || (trgMode == dspu::TRG_MODE_MANUAL));
-                c->sTrigger.set_trigger_mode(trgMode);
-                c->sTrigger.set_trigger_hysteresis(0.01f * c->sStateStage.fPV_pTrgHys * STREAM_N_VER_DIV * c->sStateStage.fPV_pVerDiv);
-                c->sTrigger.set_trigger_type(get_trigger_type(c->sStateStage.nPV_pTrgType));
-                c->sTrigger.set_trigger_threshold(0.5f * STREAM_N_VER_DIV * c->sStateStage.fPV_pVerDiv * 0.01f * c->sStateStage.fPV_pTrgLevel);
-                c->sTrigger.update_settings();
+                c->bAutoSweep           = !((trgMode == CH_TRG_MODE_SINGLE) || (trgMode == CH_TRG_MODE_MANUAL));
+                ch_trg_type_t trgType   = get_trigger_type(c->sStateStage.nPV_pTrgType);
+                float trgHys            = 0.01f * c->sStateStage.fPV_pTrgHys * STREAM_N_VER_DIV * c->sStateStage.fPV_pVerDiv;
+                float trgLevel          = 0.5f * STREAM_N_VER_DIV * c->sStateStage.fPV_pVerDiv * 0.01f * c->sStateStage.fPV_pTrgLevel;
+
+                ch_trigger_t *t         = &c->sTrigger;
+                if (t->enType != trgType)
+                    t->bArmed               = false;
+                t->enMode               = trgMode;
+                t->enType               = trgType;
+
+                switch (trgType)
+                {
+                    case CH_TRG_TYPE_SIMPLE_RISING_EDGE:
+                        t->fArmLevel            = trgLevel;
+                        t->fFireLevel           = trgLevel;
+                        t->bRising              = true;
+                        break;
+                    case CH_TRG_TYPE_SIMPLE_FALLING_EDGE:
+                        t->fArmLevel            = trgLevel;
+                        t->fFireLevel           = trgLevel;
+                        t->bRising              = false;
+                        break;
+                    case CH_TRG_TYPE_ADVANCED_RISING_EDGE:
+                        t->fArmLevel            = trgLevel - trgHys;
+                        t->fFireLevel           = trgLevel + trgHys;
+                        t->bRising              = true;
+                        break;
+                    case CH_TRG_TYPE_ADVANCED_FALLING_EDGE:
+                        t->fArmLevel            = trgLevel + trgHys;
+                        t->fFireLevel           = trgLevel - trgHys;
+                        t->bRising              = false;
+                        break;
+                    case CH_TRG_TYPE_NONE:
+                    default:
+                        t->fArmLevel            = trgLevel;
+                        t->fFireLevel           = trgLevel;
+                        t->bRising              = true;
+                        break;
+                }
             }
 
             if (c->nUpdate & UPD_TRGGER_RESET)
             {
-                c->sTrigger.reset_single_trigger();
-                c->sTrigger.activate_manual_trigger();
+                c->sTrigger.bSingleLock     = false;
+                c->sTrigger.bManualAllow    = true;
             }
 
+            if (c->nUpdate & (UPD_SCPMODE | UPD_TRIGGER_INPUT))
+                update_inputs(c);
+
             c->bClearStream = true;
 
             // Clear the update flag
             c->nUpdate = 0;
         }
 
-        bool oscilloscope::graph_stream(channel_t * c)
+        status_t oscilloscope::allocate_arena()
         {
-            // Remember size and reset head
-            size_t query_size   = c->nDisplayHead;
-            c->nDisplayHead     = 0;
+            // Release the arena which is not used anymore
+            free_aligned(pArenaRelease);
+            pArenaRelease   = NULL;
+            if (!bArenaAlloc)
+                return STATUS_OK;
+
+            // Estimate the overall size of display buffers
+            size_t samples  = 0;
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                const channel_t *c  = &vChannels[ch];
+                if (c->sBufPending.nDisplay > 0)
+                    samples            += 6 * IDISPLAY_POINTS;
+                samples            += c->sBufPending.nDisplay * DISPLAY_BUFFERS + c->sBufPending.nCapture + c->sBufPending.nSweep +
+                                      c->sBufPending.nPhosphor + c->sBufPending.nSegments + c->sBufPending.nAverage;
+            }
+            if (samples <= 0)
+                return STATUS_OK;
+
+            float *ptr      = alloc_aligned<float>(pArenaNew, samples);
+            if (ptr == NULL)
+                return STATUS_NO_MEM;
+            dsp::fill_zero(ptr, samples);
+            vArenaNew       = ptr;
+
+            return STATUS_OK;
+        }
+
+        void oscilloscope::bind_arena()
+        {
+            pArenaGarbage       = pArena;
+            pArena              = pArenaNew;
+            float *ptr          = vArenaNew;
+            pArenaNew           = NULL;
+            vArenaNew           = NULL;
+
+            // Snapshots owned by the inline display are not touched, the generation tells
+            // the inline display that they refer to the previous arena
+            atomic_add(&nArenaGen, 1);
+
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+                size_t size         = c->sBufPending.nDisplay;
+                size_t capture      = c->sBufPending.nCapture;
+                size_t sweep        = c->sBufPending.nSweep;
+                size_t phosphor     = c->sBufPending.nPhosphor;
+                size_t segments     = c->sBufPending.nSegments;
+                size_t average      = c->sBufPending.nAverage;
+
+                c->sBufCapacity     = c->sBufPending;
+                c->vDisplay_x       = (size > 0) ? advance_ptr<float>(ptr, size) : NULL;
+                c->vDisplay_y       = (size > 0) ? advance_ptr<float>(ptr, size) : NULL;
+                c->vFrame_x         = (size > 0) ? advance_ptr<float>(ptr, size) : NULL;
+                c->vFrame_y         = (size > 0) ? advance_ptr<float>(ptr, size) : NULL;
+                c->vIDisplayBuf     = (size > 0) ? advance_ptr<float>(ptr, 6 * IDISPLAY_POINTS) : NULL;
+                c->nIDisplaySize    = (size > 0) ? IDISPLAY_POINTS : 0;
+                c->vCapture         = (capture > 0) ? advance_ptr<float>(ptr, capture) : NULL;
+                c->vSweep           = (sweep > 0) ? advance_ptr<float>(ptr, sweep) : NULL;
+                c->vPhosphor        = (phosphor > 0) ? advance_ptr<float>(ptr, phosphor) : NULL;
+                c->vSegments        = (segments > 0) ? advance_ptr<float>(ptr, segments) : NULL;
+                c->vAverage         = (average > 0) ? advance_ptr<float>(ptr, average) : NULL;
+
+                // Drop the incomplete sweep and re-compute sizes
+                publish_snapshot(c, NULL, NULL, 0);
+                c->nFrameSize       = 0;
+                atomic_store(&c->nFrameState, uatomic_t(CH_FRAME_NONE));
+                c->nSegHead         = 0;
+                c->nSegCount        = 0;
+                c->nSegBatch        = 0;
+                atomic_store(&c->nSegState, uatomic_t(CH_FRAME_NONE));
+                c->nAvgCount        = 0;
+                c->nAvgSweeps       = 0;
+                c->nDisplayHead     = 0;
+                c->nDisplaySent     = 0;
+                c->nDisplayOut      = 0;
+                c->nCaptureHead     = 0;
+                c->nDataHead        = 0;
+                c->enState          = CH_STATE_LISTENING;
+                c->nUpdate         |= UPD_XY_RECORD_TIME | UPD_PRETRG_DELAY | UPD_SWEEP_GENERATOR | UPD_TRIGGER_HOLD;
+            }
+        }
+
+        void oscilloscope::update_arena(size_t samples)
+        {
+            if (pArenaAllocator == NULL)
+                return;
+
+            // Buffers can not be re-bound while the decimator uses them
+            if ((pDecimator != NULL) && (!pDecimator->idle()))
+                return;
+
+            // Bind the arena allocated in background to the channels
+            if (pArenaAllocator->completed())
+            {
+                if ((bArenaAlloc) && (pArenaAllocator->successful()))
+                {
+                    bind_arena();
+                }
+                else if (bArenaAlloc)
+                {
+                    // Keep the current buffers and do not retry the allocation immediately
+                    nArenaRetry         = dspu::seconds_to_samples(fSampleRate, ARENA_RETRY_TIME);
+                }
+
+                bArenaAlloc         = false;
+                pArenaAllocator->reset();
+            }
+
+            if (!pArenaAllocator->idle())
+                return;
+
+            // Release the previous arena once the inline display does not access it anymore.
+            // The generation is incremented before checking the flag and the inline display
+            // sets the flag before reading the generation, so it can not miss the re-bind.
+            bool release = (pArenaGarbage != NULL) && (atomic_load(&nIDisplayBusy) == 0);
+
+            // Check that display buffers need to be re-allocated
+            nArenaRetry         = (nArenaRetry > samples) ? nArenaRetry - samples : 0;
+            bool realloc = false;
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+
+                // Segment memory depends on both the sweep size and the number of segments. It is
+                // needed only for short triggered sweeps which are not shown by the phosphor display,
+                // the number of segments is reduced to fit SEGMENTS_MEMORY_MAX.
+                size_t sweep                = c->sBufRequest.nSweep;
+                size_t segments             = (sweep > 0) ? lsp_min(nSegments, SEGMENTS_MEMORY_MAX / (2 * sweep)) : 0;
+                bool segmented              = (segments > 1) && (c->enMode == CH_MODE_TRIGGERED) &&
+                                              (c->nPeakDecim <= 0) && (c->sBufRequest.nPhosphor <= 0) &&
+                                              (sweep <= dspu::seconds_to_samples(c->nOverSampleRate, PROGRESSIVE_TIME));
+                c->sBufRequest.nSegments    = (segmented) ? 2 * segments * sweep : 0;
+                c->sBufRequest.nAverage     = (enAcquisition == CH_ACQUISITION_AVERAGE) ? c->sBufRequest.nSweep : 0;
+
+                if ((c->sBufRequest.nDisplay != c->sBufCapacity.nDisplay) ||
+                    (c->sBufRequest.nCapture != c->sBufCapacity.nCapture) ||
+                    (c->sBufRequest.nSweep != c->sBufCapacity.nSweep) ||
+                    (c->sBufRequest.nPhosphor != c->sBufCapacity.nPhosphor) ||
+                    (c->sBufRequest.nSegments != c->sBufCapacity.nSegments) ||
+                    (c->sBufRequest.nAverage != c->sBufCapacity.nAverage))
+                    realloc             = true;
+            }
+
+            // Do not keep more than two arenas and do not retry the failed allocation too often
+            if ((nArenaRetry > 0) || ((pArenaGarbage != NULL) && (!release)))
+                realloc             = false;
+            if ((!realloc) && (!release))
+                return;
+
+            // Allocate and release memory outside of the realtime thread, without the executor
+            // the plugin keeps buffers allocated by init()
+            if (pExecutor == NULL)
+                return;
+
+            if (realloc)
+            {
+                for (size_t ch = 0; ch < nChannels; ++ch)
+                {
+                    channel_t *c        = &vChannels[ch];
+                    c->sBufPending      = c->sBufRequest;
+                }
+            }
+
+            bArenaAlloc         = realloc;
+            pArenaRelease       = (release) ? pArenaGarbage : NULL;
+            if (!pExecutor->submit(pArenaAllocator))
+            {
+                bArenaAlloc         = false;
+                pArenaRelease       = NULL;
+                return;
+            }
+            if (release)
+                pArenaGarbage       = NULL;
+        }
+
+        size_t oscilloscope::decimate_trace(const channel_t *c, float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count) const
+        {
+            // The sweep is reduced to the minimum and maximum per column of the graph, the X/Y
+            // trace is reduced by the distance between points. The goniometer transform scales
+            // distances by 1/sqrt(2), so the precision is adjusted to decimate the trace before
+            // the transform.
+            if (c->enMode == CH_MODE_TRIGGERED)
+                return decimate_columns(
+                    dst_x, dst_y, src_x, src_y,
+                    count, -SWEEP_GEN_PEAK, SWEEP_GEN_PEAK, lsp_max(nMaxDots >> 1, size_t(1)));
+
+            return decimate(
+                dst_x, dst_y, src_x, src_y,
+                count, (c->enMode == CH_MODE_GONIOMETER) ? 2.0f * DECIM_PRECISION : DECIM_PRECISION);
+        }
+
+        void oscilloscope::sweep_points(const channel_t *c, float *dst, size_t first, size_t count, float shift) const
+        {
+            // The sweep table is interpolated linearly at the shifted position
+            const float *src    = &c->vSweep[first];
+            size_t size         = c->nSweepSize;
+            if ((shift == 0.0f) || (size < 2))
+            {
+                dsp::copy(dst, src, count);
+                return;
+            }
+
+            size_t to_do        = (first + count < size) ? count : lsp_max(size - 1, first) - first;
+            dsp::mix_copy2(dst, src, &src[1], 1.0f - shift, shift, to_do);
+
+            // The last point of the table is extrapolated
+            for (size_t i = to_do; i < count; ++i)
+            {
+                size_t j            = lsp_min(first + i, size - 1);
+                dst[i]              = c->vSweep[j] + shift * (c->vSweep[j] - c->vSweep[j - 1]);
+            }
+        }
+
+        void oscilloscope::transform_trace(const channel_t *c, float *x, float *y, size_t count) const
+        {
+            // Apply XY -> MS for goniometer mode, scaling and offset in one pass.
+            // X is to be scaled and offset only in XY and goniometer modes.
+            transform_t t;
+            switch (c->enMode)
+            {
+                case CH_MODE_GONIOMETER:
+                    t.kxx       = -0.5f * c->fHorStreamScale;
+                    t.kxy       = 0.5f * c->fHorStreamScale;
+                    t.kyx       = 0.5f * c->fVerStreamScale;
+                    t.kyy       = 0.5f * c->fVerStreamScale;
+                    t.bx        = c->fHorStreamOffset;
+                    t.by        = c->fVerStreamOffset;
+                    break;
+                case CH_MODE_XY:
+                    t.kxx       = c->fHorStreamScale;
+                    t.kxy       = 0.0f;
+                    t.kyx       = 0.0f;
+                    t.kyy       = c->fVerStreamScale;
+                    t.bx        = c->fHorStreamOffset;
+                    t.by        = c->fVerStreamOffset;
+                    break;
+                case CH_MODE_TRIGGERED:
+                default:
+                    t.kxx       = 1.0f;
+                    t.kxy       = 0.0f;
+                    t.kyx       = 0.0f;
+                    t.kyy       = c->fVerStreamScale;
+                    t.bx        = 0.0f;
+                    t.by        = c->fVerStreamOffset;
+                    break;
+            }
+            transform_points(x, y, &t, count);
+        }
+
+        void oscilloscope::submit_trace(channel_t *c, plug::stream_t *stream, float *x, float *y, size_t count, bool strobe)
+        {
+            transform_trace(c, x, y, count);
+
+            // Submit data for plotting (emit the figure data with fixed-size frames):
+            const float strobe_value = 1.0f;
+            for (size_t i = 0; i < count; )  // nSweepSize can be as big as BUF_LIM_SIZE !!!
+            {
+                size_t n = stream->add_frame(count - i);             // Add a frame
+                stream->write_frame(0, &x[i], 0, n);                 // X'es
+                stream->write_frame(1, &y[i], 0, n);                 // Y's
+                for (size_t k = 0; k < n; )                          // Strobe signal, zero except the first point
+                {
+                    size_t to_do = lsp_min(n - k, size_t(BUF_BLOCK_SIZE));
+                    stream->write_frame(2, vStrobe, k, to_do);
+                    k += to_do;
+                }
+                if ((i == 0) && (strobe))
+                    stream->write_frame(2, &strobe_value, 0, 1);
+                stream->commit_frame();                              // Commit the frame
+
+                // Move the index in the source buffer
+                i += n;
+            }
+        }
+
+        void oscilloscope::publish_snapshot(channel_t *c, const float *x, const float *y, size_t count)
+        {
+            // Fill the snapshot owned by the writer, bind it to the current arena first
+            ch_snapshot_t *sn   = &c->vIDisplay[c->nIDisplayWrite];
+            size_t gen          = atomic_load(&nArenaGen);
+            if (sn->nGen != gen)
+            {
+                float *buf          = (c->vIDisplayBuf != NULL) ? &c->vIDisplayBuf[2 * c->nIDisplayWrite * c->nIDisplaySize] : NULL;
+                sn->vX              = buf;
+                sn->vY              = (buf != NULL) ? &buf[c->nIDisplaySize] : NULL;
+                sn->nGen            = gen;
+            }
+            // The snapshot keeps a limited number of points, the inline display is small
+            size_t size         = 0;
+            if (sn->vX != NULL)
+            {
+                size                = reduce_points(sn->vX, sn->vY, x, y, count, c->nIDisplaySize);
+                size                = decimate(sn->vX, sn->vY, sn->vX, sn->vY, size, IDISPLAY_DECIM);
+            }
+            sn->nSize           = size;
+            sn->nSeq            = ++c->nIDisplaySeq;
+
+            // Publish it as the latest one and take the previous latest snapshot for the next write
+            uatomic_t prev      = atomic_swap(&c->nIDisplayLatest, uatomic_t(c->nIDisplayWrite | IDISPLAY_FRESH));
+            c->nIDisplayWrite   = prev & IDISPLAY_INDEX;
+        }
+
+        bool oscilloscope::fetch_snapshot(channel_t *c)
+        {
+            if (!(atomic_load(&c->nIDisplayLatest) & IDISPLAY_FRESH))
+                return false;
+
+            // Give the drawn snapshot back and take the latest one
+            uatomic_t prev      = atomic_swap(&c->nIDisplayLatest, uatomic_t(c->nIDisplayRead));
+            c->nIDisplayRead    = prev & IDISPLAY_INDEX;
+            return true;
+        }
+
+        bool oscilloscope::graph_stream(channel_t * c, bool complete)
+        {
+            // Points [first, last) of the display buffer are not submitted yet,
+            // decimated points are appended after already submitted ones
+            size_t first        = c->nDisplaySent;
+            size_t query_size   = c->nDisplayHead - first;
+            size_t out          = c->nDisplayOut;
+            if (complete)
+            {
+                c->nDisplayHead     = 0;
+                c->nDisplaySent     = 0;
+                c->nDisplayOut      = 0;
+            }
+
+            // Phosphor display accumulates points instead of passing them to the stream
+            if ((bPhosphor) && (c->vPhosphor != NULL))
+                return accumulate_trace(c, first, query_size, complete);
 
             // Check that stream is present
             plug::stream_t *stream = c->pStream->buffer<plug::stream_t>();
@@ -864,106 +2512,379 @@ namespace lsp
                 c->bClearStream = false;
             }
 
-            // Transform XY -> MS for goniomteter mode
-            if (c->enMode == CH_MODE_GONIOMETER)
-                dsp::lr_to_ms(c->vDisplay_y, c->vDisplay_x, c->vDisplay_y, c->vDisplay_x, query_size);
+            // In triggered mode X coordinates are computed from the sweep table, decimation is in-place
+            float *dst_x        = &c->vDisplay_x[out];
+            float *dst_y        = &c->vDisplay_y[out];
+            const float *src_x  = &c->vDisplay_x[first];
+            const float *src_y  = &c->vDisplay_y[first];
+            if (c->enMode == CH_MODE_TRIGGERED)
+                sweep_points(c, &c->vDisplay_x[first], first, query_size, c->fSweepShift);
+
+            size_t to_submit    = decimate_trace(c, dst_x, dst_y, src_x, src_y, query_size);
+            submit_trace(c, stream, dst_x, dst_y, to_submit, out == 0);
+
+            // Incomplete trace is not shown on the inline display
+            if (!complete)
+            {
+                c->nDisplaySent     = first + query_size;
+                c->nDisplayOut      = out + to_submit;
+                return false;
+            }
+
+            // Is there data to submit to inline display?
+            to_submit          += out;
+            if (to_submit > 0)
+                publish_snapshot(c, c->vDisplay_x, c->vDisplay_y, to_submit);
+
+            return true;
+        }
+
+        bool oscilloscope::accumulate_trace(channel_t *c, size_t first, size_t count, bool complete)
+        {
+            if (!complete)
+                c->nDisplaySent     = first + count;
+            if (c->bFreeze)
+                return false;
+
+            // Transform points in-place, in triggered mode X coordinates are computed from the sweep table
+            float *x            = &c->vDisplay_x[first];
+            float *y            = &c->vDisplay_y[first];
+            if (c->enMode == CH_MODE_TRIGGERED)
+                sweep_points(c, x, first, count, c->fSweepShift);
+            transform_trace(c, x, y, count);
+            accumulate_hits(c->vPhosphor, x, y, count);
+
+            // Incomplete trace is not shown on the inline display
+            if (!complete)
+                return false;
+
+            count              += first;
+            if (count > 0)
+                publish_snapshot(c, c->vDisplay_x, c->vDisplay_y, count);
+
+            return true;
+        }
+
+        void oscilloscope::plot_phosphor(size_t samples)
+        {
+            if (!bPhosphor)
+            {
+                nPhosphorCounter    = 0;
+                return;
+            }
+
+            // Pass images to the UI with the fixed frame rate
+            size_t period       = lsp_max(size_t(fSampleRate / UI_FRAME_RATE), size_t(1));
+            nPhosphorCounter   += samples;
+            if (nPhosphorCounter < period)
+                return;
 
-            // In-place decimation:
-            size_t j = 0;
+            // Hits fade out exponentially like the afterglow of the analog oscilloscope
+            const size_t rows   = meta::oscilloscope_metadata::PHOSPHOR_ROWS;
+            const size_t cols   = meta::oscilloscope_metadata::PHOSPHOR_COLS;
+            float decay         = expf(-1000.0f * nPhosphorCounter / (fSampleRate * fPhosphorDecay));
+            nPhosphorCounter    = 0;
 
-            for (size_t i = 1; i < query_size; ++i)
+            for (size_t ch = 0; ch < nChannels; ++ch)
             {
-                float dx    = c->vDisplay_x[i] - c->vDisplay_x[j];
-                float dy    = c->vDisplay_y[i] - c->vDisplay_y[j];
-                float s     = dx*dx + dy*dy;
+                channel_t *c        = &vChannels[ch];
+                if ((c->vPhosphor == NULL) || (c->bSuspended))
+                    continue;
 
-                if (s < DECIM_PRECISION) // Skip point
+                // Normalize the image to the brightest cell. The frame buffer shows
+                // the last written row at the top, so rows are written bottom-up.
+                plug::frame_buffer_t *fb = c->pFrameBuffer->buffer<plug::frame_buffer_t>();
+                if (fb != NULL)
                 {
-                    c->vDisplay_s[j] = lsp_max(c->vDisplay_s[i], c->vDisplay_s[j]); // Keep the strobe signal
+                    float peak          = dsp::max(c->vPhosphor, rows * cols);
+                    float norm          = (peak > 0.0f) ? 1.0f / peak : 0.0f;
+                    for (size_t i = rows; i > 0; )
+                    {
+                        --i;
+                        dsp::mul_k3(fb->next_row(), &c->vPhosphor[i * cols], norm, cols);
+                        fb->write_row();
+                    }
+                }
+
+                dsp::mul_k2(c->vPhosphor, decay, rows * cols);
+            }
+        }
+
+        inline bool oscilloscope::is_averaging(const channel_t *c) const
+        {
+            return (enAcquisition == CH_ACQUISITION_AVERAGE) && (c->vAverage != NULL) && (c->enMode == CH_MODE_TRIGGERED);
+        }
+
+        bool oscilloscope::average_trace(channel_t *c)
+        {
+            size_t size         = lsp_min(c->nDisplayHead, c->sBufCapacity.nAverage);
+
+            // Running average of the first sweeps turns into the exponential one after nAverage sweeps
+            if (c->nAvgCount <= 0)
+            {
+                dsp::copy(c->vAverage, c->vDisplay_y, size);
+                c->fAvgShift        = c->fSweepShift;
+            }
+            else
+            {
+                float k             = 1.0f / float(lsp_min(c->nAvgCount + 1, nAverage));
+                dsp::mix2(c->vAverage, c->vDisplay_y, 1.0f - k, k, size);
+                c->fAvgShift       += (c->fSweepShift - c->fAvgShift) * k;
+            }
+            c->nAvgCount        = lsp_min(c->nAvgCount + 1, nAverage);
+
+            if ((++c->nAvgSweeps) < nAverage)
+            {
+                c->nDisplayHead     = 0;
+                c->nDisplaySent     = 0;
+                c->nDisplayOut      = 0;
+                return false;
+            }
+
+            // Replace the sweep with the average and pass it further
+            c->nAvgSweeps       = 0;
+            dsp::copy(c->vDisplay_y, c->vAverage, size);
+            c->nDisplayHead     = size;
+            c->fSweepShift      = c->fAvgShift;
+            return true;
+        }
+
+        bool oscilloscope::store_segment(channel_t *c)
+        {
+            size_t size         = c->nDisplayHead;
+            c->nDisplayHead     = 0;
+            c->nDisplaySent     = 0;
+            c->nDisplayOut      = 0;
+
+            // The segment memory is full, sweeps are dropped until the batch is passed to the UI
+            size_t stride       = c->sBufCapacity.nSweep;
+            size_t capacity     = (stride > 0) ? c->sBufCapacity.nSegments / (2 * stride) : 0;
+            if (c->nSegCount >= lsp_min(capacity, nSegments))
+                return false;
+
+            // Segments captured while the batch is decimated are appended after it
+            size_t index        = (c->nSegHead + c->nSegCount) % capacity;
+            ch_segment_t *sg    = &c->vSegment[index];
+            sg->nSize           = lsp_min(size, stride);
+            sg->nTime           = c->nTrgClock;
+            sg->fTime           = 0.0f;
+            sg->fShift          = c->fSweepShift;
+            dsp::copy(&c->vSegments[(2 * index + 1) * stride], c->vDisplay_y, sg->nSize);
+            ++c->nSegCount;
+
+            return false;
+        }
+
+        void oscilloscope::queue_segments(size_t samples)
+        {
+            if (nSegments <= 1)
+            {
+                nSegmentCounter     = 0;
+                return;
+            }
+
+            // Pass batches to the UI with the fixed frame rate
+            size_t period       = lsp_max(size_t(fSampleRate / UI_FRAME_RATE), size_t(1));
+            nSegmentCounter    += samples;
+            if (nSegmentCounter < period)
+                return;
+            nSegmentCounter     = 0;
+
+            // Captured segments are decimated in background, the previous batch should be plotted first
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+                if ((c->nSegCount <= 0) || (atomic_load(&c->nSegState) != CH_FRAME_NONE))
                     continue;
+
+                c->nSegBatch        = c->nSegCount;
+                atomic_store(&c->nSegState, uatomic_t(CH_FRAME_PENDING));
+            }
+        }
+
+        bool oscilloscope::plot_segments()
+        {
+            bool query_draw     = false;
+
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+                if (atomic_load(&c->nSegState) != CH_FRAME_READY)
+                    continue;
+
+                size_t stride       = c->sBufCapacity.nSweep;
+                size_t capacity     = c->sBufCapacity.nSegments / (2 * stride);
+                size_t head         = c->nSegHead;
+                size_t count        = c->nSegBatch;
+
+                // Release the batch, segments captured meanwhile become the head of the ring
+                c->nSegHead         = (head + count) % capacity;
+                c->nSegCount       -= count;
+                c->nSegBatch        = 0;
+                atomic_store(&c->nSegState, uatomic_t(CH_FRAME_NONE));
+
+                plug::stream_t *stream = c->pStream->buffer<plug::stream_t>();
+                if ((stream == NULL) || (c->bFreeze))
+                    continue;
+
+                if (c->bClearStream)
+                {
+                    stream->clear();
+                    c->bClearStream = false;
                 }
 
-                // Add point to decimated array
-                ++j;
-                c->vDisplay_x[j] = c->vDisplay_x[i];
-                c->vDisplay_y[j] = c->vDisplay_y[i];
+                // Submit all segments at once, the last one is shown on the inline display
+                for (size_t i=0; i<count; ++i)
+                {
+                    size_t index        = (head + i) % capacity;
+                    const ch_segment_t *sg  = &c->vSegment[index];
+                    float *x            = &c->vSegments[2 * index * stride];
+                    float *y            = &x[stride];
+                    submit_trace(c, stream, x, y, sg->nSize, true);
+                    if ((i + 1) >= count)
+                        publish_snapshot(c, x, y, sg->nSize);
+                }
+                query_draw          = true;
             }
 
-            // Detect occasional jumps
-            size_t to_submit = j + 1; // Total number of decimated samples.
+            return query_draw;
+        }
+
+        bool oscilloscope::complete_trace(channel_t *c)
+        {
+            // Only the averaged sweep is passed further each nAverage sweeps
+            if ((is_averaging(c)) && (!average_trace(c)))
+                return false;
 
-            // Apply scaling and offset:
-            dsp::mul_k2(c->vDisplay_y, c->fVerStreamScale, to_submit);
-            dsp::add_k2(c->vDisplay_y, c->fVerStreamOffset, to_submit);
+            // Short sweeps are stored in the segment memory and passed to the UI in batches
+            if ((nSegments > 1) && (c->vSegments != NULL) && (!c->bProgressive) &&
+                (pDecimator != NULL) && (pExecutor != NULL) &&
+                (c->enMode == CH_MODE_TRIGGERED) && (!((bPhosphor) && (c->vPhosphor != NULL))))
+                return store_segment(c);
 
-            // x is to be scaled and offset only in XY mode
-            if ((c->enMode == CH_MODE_XY) || (c->enMode == CH_MODE_GONIOMETER))
+            // Progressive sweeps are mostly submitted already, complete them immediately.
+            // Phosphor display does not decimate the trace at all.
+            if (streams_directly(c))
+                return graph_stream(c, true);
+
+            // The previous trace of the channel is still being decimated, drop this one to keep the order
+            if (atomic_load(&c->nFrameState) != CH_FRAME_NONE)
             {
-                dsp::mul_k2(c->vDisplay_x, c->fHorStreamScale, to_submit);
-                dsp::add_k2(c->vDisplay_x, c->fHorStreamOffset, to_submit);
+                c->nDisplayHead     = 0;
+                c->nDisplaySent     = 0;
+                c->nDisplayOut      = 0;
+                return false;
             }
 
-    //    #ifdef LSP_TRACE
-    //        for (size_t i=1; i < to_submit; ++i)
-    //        {
-    //            float dx    = c->vDisplay_x[i] - c->vDisplay_x[i-1];
-    //            float dy    = c->vDisplay_y[i] - c->vDisplay_y[i-1];
-    //            float s     = dx*dx + dy*dy;
-    //            if ((s >= 0.125f) && (c->vDisplay_s[i] <= 0.5f))
-    //            {
-    //                lsp_trace("debug");
-    //            }
-    //        }
-    //    #endif
+            // Swap buffers and pass the trace to the decimator, it is started by process() when idle
+            float *x            = c->vFrame_x;
+            float *y            = c->vFrame_y;
+            c->vFrame_x         = c->vDisplay_x;
+            c->vFrame_y         = c->vDisplay_y;
+            c->vDisplay_x       = x;
+            c->vDisplay_y       = y;
+            c->nFrameSize       = c->nDisplayHead;
+            c->fFrameShift      = c->fSweepShift;
+            atomic_store(&c->nFrameState, uatomic_t(CH_FRAME_PENDING));
 
-            // Submit data for plotting (emit the figure data with fixed-size frames):
-            for (size_t i = 0; i < to_submit; )  // nSweepSize can be as big as BUF_LIM_SIZE !!!
+            c->nDisplayHead     = 0;
+            c->nDisplaySent     = 0;
+            c->nDisplayOut      = 0;
+
+            return false;
+        }
+
+        status_t oscilloscope::decimate_frames()
+        {
+            for (size_t ch = 0; ch < nChannels; ++ch)
             {
-                size_t count = stream->add_frame(to_submit - i);     // Add a frame
-                stream->write_frame(0, &c->vDisplay_x[i], 0, count); // X'es
-                stream->write_frame(1, &c->vDisplay_y[i], 0, count); // Y's
-                stream->write_frame(2, &c->vDisplay_s[i], 0, count); // Strobe signal
-                stream->commit_frame();                              // Commit the frame
+                channel_t *c        = &vChannels[ch];
 
-                // Move the index in the source buffer
-                i += count;
+                // Claim the trace, the audio thread does not touch frame buffers until the trace is ready
+                if (!atomic_cas(&c->nFrameState, uatomic_t(CH_FRAME_PENDING), uatomic_t(CH_FRAME_DECIMATING)))
+                    continue;
+
+                // In triggered mode X coordinates are computed from the sweep table
+                if (c->enMode == CH_MODE_TRIGGERED)
+                    sweep_points(c, c->vFrame_x, 0, c->nFrameSize, c->fFrameShift);
+                c->nFrameSize       = decimate_trace(c, c->vFrame_x, c->vFrame_y, c->vFrame_x, c->vFrame_y, c->nFrameSize);
+                atomic_store(&c->nFrameState, uatomic_t(CH_FRAME_READY));
             }
 
-            // Is there data to submit to inline display?
-            if (to_submit > 0)
+            for (size_t ch = 0; ch < nChannels; ++ch)
             {
-                // Compute the start point to submit data
-                j   = 0;
+                channel_t *c        = &vChannels[ch];
+
+                // Claim the batch of segments, each segment is decimated in place
+                if (!atomic_cas(&c->nSegState, uatomic_t(CH_FRAME_PENDING), uatomic_t(CH_FRAME_DECIMATING)))
+                    continue;
+
+                size_t stride       = c->sBufCapacity.nSweep;
+                size_t capacity     = c->sBufCapacity.nSegments / (2 * stride);
+                wsize_t start       = c->vSegment[c->nSegHead].nTime;
+                for (size_t i=0; i<c->nSegBatch; ++i)
+                {
+                    size_t index        = (c->nSegHead + i) % capacity;
+                    ch_segment_t *sg    = &c->vSegment[index];
+                    sg->fTime           = float(sg->nTime - start) / fSampleRate;
+                    float *x            = &c->vSegments[2 * index * stride];
+                    float *y            = &x[stride];
+                    sweep_points(c, x, 0, sg->nSize, sg->fShift);
+                    sg->nSize           = decimate_trace(c, x, y, x, y, sg->nSize);
+                }
+                atomic_store(&c->nSegState, uatomic_t(CH_FRAME_READY));
+            }
+
+            return STATUS_OK;
+        }
+
+        bool oscilloscope::plot_frames()
+        {
+            bool query_draw     = false;
 
-                // In-place decimation:
-                for (size_t i = j+1; i < to_submit; ++i)
-                {
-                    float dx    = c->vDisplay_x[i] - c->vDisplay_x[j];
-                    float dy    = c->vDisplay_y[i] - c->vDisplay_y[j];
-                    float s     = dx*dx + dy*dy;
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+                if (atomic_load(&c->nFrameState) != CH_FRAME_READY)
+                    continue;
+                atomic_store(&c->nFrameState, uatomic_t(CH_FRAME_NONE));
 
-                    if (s < IDISPLAY_DECIM) // Skip point
-                        continue;
+                // Check that stream is present
+                plug::stream_t *stream = c->pStream->buffer<plug::stream_t>();
+                if ((stream == NULL) || (c->bFreeze))
+                    continue;
 
-                    // Add point to decimated array
-                    ++j;
-                    c->vDisplay_x[j] = c->vDisplay_x[i];
-                    c->vDisplay_y[j] = c->vDisplay_y[i];
+                if (c->bClearStream)
+                {
+                    stream->clear();
+                    c->bClearStream = false;
                 }
 
-                // Copy display data to inline display buffer.
-                c->nIDisplay = j + 1;
-                dsp::copy(c->vIDisplay_x, c->vDisplay_x, c->nIDisplay);
-                dsp::copy(c->vIDisplay_y, c->vDisplay_y, c->nIDisplay);
+                submit_trace(c, stream, c->vFrame_x, c->vFrame_y, c->nFrameSize, true);
+
+                if (c->nFrameSize > 0)
+                    publish_snapshot(c, c->vFrame_x, c->vFrame_y, c->nFrameSize);
+                query_draw          = true;
             }
 
-            return true;
+            return query_draw;
         }
 
         void oscilloscope::update_settings()
         {
             float xy_rectime    = pXYRecordTime->value();
             bool g_freeze       = pFreeze->value() >= 0.5f;
+            fSilence            = (pSilenceGate->value() >= 0.5f) ? pSilence->value() : 0.0f;
+            bool base_trg       = pBaseTrigger->value() >= 0.5f;
+            bParallel           = (pParallel != NULL) ? pParallel->value() >= 0.5f : false;
+            bPhosphor           = pPhosphor->value() >= 0.5f;
+            fPhosphorDecay      = pPhosphorDecay->value();
+            nSegments           = lsp_max(size_t(pSegments->value()), size_t(1));
+            enAcquisition       = get_acquisition_mode(pAcquisition->value());
+            nAverage            = lsp_max(size_t(pAverage->value()), size_t(1));
+            size_t max_dots     = pMaxDots->value();
+            bool dots_changed   = max_dots != nMaxDots;
+            nMaxDots            = max_dots;
             bool has_solo       = false;
 
             for (size_t ch = 0; ch < nChannels; ++ch)
@@ -996,6 +2917,19 @@ namespace lsp
                     c->nUpdate |= UPD_XY_RECORD_TIME;
                 }
 
+                if (dots_changed)
+                    c->nUpdate |= UPD_OVERSAMPLER_AUTO;
+
+                // The histogram is allocated by the arena allocator only while the phosphor mode is on
+                c->sBufRequest.nPhosphor    = (bPhosphor) ?
+                    meta::oscilloscope_metadata::PHOSPHOR_ROWS * meta::oscilloscope_metadata::PHOSPHOR_COLS : 0;
+
+                if (base_trg != c->sStateStage.bPV_pBaseTrigger)
+                {
+                    c->sStateStage.bPV_pBaseTrigger = base_trg;
+                    c->nUpdate |= UPD_TRIGGER_RATE | UPD_OVERSAMPLER_Y | UPD_SWEEP_GENERATOR | UPD_TRIGGER_HOLD;
+                }
+
                 size_t scpmode = (c->bUseGlobal) ? pScpMode->value() : c->pScpMode->value();
                 if (scpmode != c->sStateStage.nPV_pScpMode)
                 {
@@ -1139,181 +3073,493 @@ namespace lsp
 
                 c->sSweepGenerator.set_sample_rate(sr);
                 c->sSweepGenerator.update_settings();
+
+                // Automatic oversampling factor depends on the sample rate
+                c->nUpdate |= UPD_OVERSAMPLER_AUTO;
             }
         }
 
-        void oscilloscope::process(size_t samples)
+        bool oscilloscope::streams_directly(const channel_t *c) const
         {
-            // Prepare channels
-            for (size_t ch = 0; ch < nChannels; ++ch)
-            {
-                channel_t *c = &vChannels[ch];
-
-                c->vIn_x    = c->pIn_x->buffer<float>();
-                c->vIn_y    = c->pIn_y->buffer<float>();
-                c->vIn_ext  = c->pIn_ext->buffer<float>();
+            return (c->bProgressive) || (pDecimator == NULL) || (pExecutor == NULL) || (c->vFrame_x == NULL) ||
+                ((bPhosphor) && (c->vPhosphor != NULL));
+        }
 
-                c->vOut_x   = c->pOut_x->buffer<float>();
-                c->vOut_y   = c->pOut_y->buffer<float>();
+        bool oscilloscope::may_complete(const channel_t *c, size_t points)
+        {
+            // The trace is completed when the display buffer is filled up
+            if (c->enMode != CH_MODE_TRIGGERED)
+                return c->nDisplayHead + points >= c->nXYRecordSize;
+            size_t head         = (c->enState == CH_STATE_SWEEPING) ? c->nDisplayHead : 0;
+            return head + points >= c->nSweepSize;
+        }
 
-                if ((c->vIn_x == NULL) || (c->vIn_y == NULL))
-                    return;
+        bool oscilloscope::process_channel(channel_t *c, size_t samples, const ch_scratch_t *s)
+        {
+            c->bResume      = false;
 
-                if (c->vIn_ext == NULL)
-                    return;
+            // Settings are not applied while the decimator uses the channel buffers
+            if ((atomic_load(&c->nFrameState) == CH_FRAME_NONE) &&
+                (atomic_load(&c->nSegState) == CH_FRAME_NONE))
+                commit_staged_state_change(c);
 
-                c->nSamplesCounter = samples;
+            // Frozen and hidden channels do not need acquisition
+            if ((c->bFreeze) || (!c->bVisible))
+            {
+                suspend_channel(c, samples, s);
+                c->nClock          += samples;
+                return false;
             }
+            else if (c->bSuspended)
+                resume_channel(c);
 
-            // Bypass signal
-            for (size_t ch = 0; ch < nChannels; ++ch)
-            {
-                channel_t *c = &vChannels[ch];
+            // Buffers are not allocated yet?
+            if (((c->enMode == CH_MODE_TRIGGERED) ? c->nSweepSize : c->nXYRecordSize) <= 0)
+                return false;
 
-                if (c->vOut_x != NULL)
-                    dsp::copy(c->vOut_x, c->vIn_x, samples);
-                if (c->vOut_y != NULL)
-                    dsp::copy(c->vOut_y, c->vIn_y, samples);
-            }
+            return acquire_channel(c, s);
+        }
 
+        bool oscilloscope::acquire_channel(channel_t *c, const ch_scratch_t *s)
+        {
             bool query_draw = false;
 
-            // Process each channel
-            for (size_t ch = 0; ch < nChannels; ++ch)
+            while (c->nSamplesCounter > 0)
             {
-                channel_t *c = &vChannels[ch];
+                size_t requested        = c->nOversampling * c->nSamplesCounter;
+                size_t availble         = BUF_BLOCK_SIZE;
+                if (c->enMode == CH_MODE_TRIGGERED)
+                {
+                    size_t capture          = c->sBufCapacity.nCapture - c->nCaptureHead;
+                    availble                = lsp_min(availble, (c->bBaseTrigger) ? capture * c->nOversampling : capture);
+                }
+                size_t to_do_upsample   = (requested < availble) ? requested : availble;
+                size_t to_do            = to_do_upsample / c->nOversampling;
 
-                commit_staged_state_change(c);
+                // Peak detection stores a pair of points per group of samples at the original sample rate
+                if ((c->enMode == CH_MODE_TRIGGERED) && (c->nPeakDecim > 0))
+                {
+                    size_t capture          = ((c->sBufCapacity.nCapture - c->nCaptureHead) / peak_points(c->nPeakDecim)) * c->nPeakDecim - c->nPeakCounter;
+                    to_do                   = lsp_min(c->nSamplesCounter, lsp_min(size_t(BUF_BLOCK_SIZE), capture));
+                    to_do_upsample          = to_do;
+                }
+
+                // Workers do not access streams, the rest of the block is left to the audio
+                // thread if it may complete the trace which is passed to the stream directly
+                if ((!s->bAudio) && (streams_directly(c)) && (may_complete(c, to_do_upsample)))
+                {
+                    c->bResume          = true;
+                    break;
+                }
+
+                // Skip samples while the oversampler warms up after resume
+                size_t warm_up          = lsp_min(c->nWarmUp, to_do_upsample);
+                c->nWarmUp             -= warm_up;
 
-                while (c->nSamplesCounter > 0)
+                // Silent inputs do not need oversampling and trigger search
+                bool silent             = is_silent(c, to_do);
+                if (silent != c->bSilent)
                 {
-                    size_t requested        = c->nOversampling * c->nSamplesCounter;
-                    size_t availble         = BUF_LIM_SIZE;
-                    size_t to_do_upsample   = (requested < availble) ? requested : availble;
-                    size_t to_do            = to_do_upsample / c->nOversampling;
+                    // Drop the filter history when the signal returns, it corresponds to silence
+                    if (!silent)
+                        reset_inputs(c, c->nInputs);
+                    c->bSilent              = silent;
+                }
 
-                    switch (c->enMode)
+                switch (c->enMode)
+                {
+                    case CH_MODE_XY:
+                    case CH_MODE_GONIOMETER:
                     {
-                        case CH_MODE_XY:
-                        case CH_MODE_GONIOMETER:
+                        if (silent)
+                        {
+                            dsp::fill_zero(s->vData_x, to_do_upsample);
+                            dsp::fill_zero(s->vData_y, to_do_upsample);
+                        }
+                        else
                         {
                             if (c->enCoupling_x == CH_COUPLING_AC)
                             {
-                                c->sDCBlockBank_x.process(c->vTemp, c->vIn_x, to_do);
-                                c->sOversampler_x.upsample(c->vData_x, c->vTemp, to_do);
+                                c->sDCBlockBank_x.process(s->vTemp, c->vIn_x, to_do);
+                                c->sOversampler_x.upsample(s->vData_x, s->vTemp, to_do);
                             }
                             else
-                                c->sOversampler_x.upsample(c->vData_x, c->vIn_x, to_do);
+                                c->sOversampler_x.upsample(s->vData_x, c->vIn_x, to_do);
 
                             if (c->enCoupling_y == CH_COUPLING_AC)
                             {
-                                c->sDCBlockBank_y.process(c->vTemp, c->vIn_y, to_do);
-                                c->sOversampler_y.upsample(c->vData_y, c->vTemp, to_do);
+                                c->sDCBlockBank_y.process(s->vTemp, c->vIn_y, to_do);
+                                c->sOversampler_y.upsample(s->vData_y, s->vTemp, to_do);
                             }
                             else
-                                c->sOversampler_y.upsample(c->vData_y, c->vIn_y, to_do);
+                                c->sOversampler_y.upsample(s->vData_y, c->vIn_y, to_do);
+                        }
 
-                            for (size_t n = 0; n < to_do_upsample; )
+                        for (size_t n = warm_up; n < to_do_upsample; )
+                        {
+                            ssize_t count = lsp_min(ssize_t(c->nXYRecordSize - c->nDisplayHead), ssize_t(to_do_upsample - n));
+                            if (count <= 0)
                             {
-                                ssize_t count = lsp_min(ssize_t(c->nXYRecordSize - c->nDisplayHead), ssize_t(to_do_upsample - n));
-                                if (count <= 0)
-                                {
-                                    // Plot time!
-                                    if (graph_stream(c))
-                                        query_draw      = true;
-                                    continue;
-                                }
+                                // Plot time!
+                                if (complete_trace(c))
+                                    query_draw      = true;
+                                continue;
+                            }
 
-                                // Move data to intermediate buffers
-                                dsp::copy(&c->vDisplay_x[c->nDisplayHead], &c->vData_x[n], count);
-                                dsp::copy(&c->vDisplay_y[c->nDisplayHead], &c->vData_y[n], count);
-                                dsp::fill_zero(&c->vDisplay_s[c->nDisplayHead], count);
-                                if (c->nDisplayHead == 0)
-                                    c->vDisplay_s[0]        = 1.0f;
+                            // Move data to intermediate buffers
+                            dsp::copy(&c->vDisplay_x[c->nDisplayHead], &s->vData_x[n], count);
+                            dsp::copy(&c->vDisplay_y[c->nDisplayHead], &s->vData_y[n], count);
 
-                                // Update pointers
-                                c->nDisplayHead    += count;
-                                n                  += count;
-                            }
+                            // Update pointers
+                            c->nDisplayHead    += count;
+                            n                  += count;
+                        }
+
+                    }
+                    break;
 
+                    case CH_MODE_TRIGGERED:
+                    {
+                        // The trigger is searched before upsampling
+                        if ((c->bBaseTrigger) && (c->nPeakDecim == 0))
+                        {
+                            if (acquire_base_rate(c, to_do, silent, s))
+                                query_draw      = true;
+                            break;
                         }
-                        break;
 
-                        case CH_MODE_TRIGGERED:
+                        // Oversampled data is stored directly in the capture buffer
+                        float *data_y = &c->vCapture[c->nCaptureHead];
+                        size_t points = to_do_upsample;
+                        if (c->nPeakDecim > 0)
                         {
-                            if (c->enCoupling_y == CH_COUPLING_AC)
+                            // Peak detection does not need oversampling
+                            if (silent)
                             {
-                                c->sDCBlockBank_y.process(c->vTemp, c->vIn_y, to_do);
-                                c->sOversampler_y.upsample(c->vData_y, c->vTemp, to_do);
+                                points          = peak_points(c->nPeakDecim) * ((c->nPeakCounter + to_do) / c->nPeakDecim);
+                                dsp::fill_zero(data_y, points);
+                                dsp::fill_zero(s->vData_ext, points);
+                                c->sPeak_y.fMin     = 0.0f;
+                                c->sPeak_y.fMax     = 0.0f;
+                                c->sPeak_ext.fMin   = 0.0f;
+                                c->sPeak_ext.fMax   = 0.0f;
                             }
                             else
-                                c->sOversampler_y.upsample(c->vData_y, c->vIn_y, to_do);
+                            {
+                                const float *src    = c->vIn_y;
+                                if (c->enCoupling_y == CH_COUPLING_AC)
+                                {
+                                    c->sDCBlockBank_y.process(s->vTemp, c->vIn_y, to_do);
+                                    src                 = s->vTemp;
+                                }
+                                points          = peak_detect(data_y, src, to_do, &c->sPeak_y, c->nPeakDecim, c->nPeakCounter);
+
+                                if (c->nInputs & CH_INPUT_EXT)
+                                {
+                                    src                 = c->vIn_ext;
+                                    if (c->enCoupling_ext == CH_COUPLING_AC)
+                                    {
+                                        c->sDCBlockBank_ext.process(s->vTemp, c->vIn_ext, to_do);
+                                        src                 = s->vTemp;
+                                    }
+                                    peak_detect(s->vData_ext, src, to_do, &c->sPeak_ext, c->nPeakDecim, c->nPeakCounter);
+                                }
+                            }
 
-                            c->sPreTrgDelay.process(c->vData_y_delay, c->vData_y, to_do_upsample);
+                            c->nPeakCounter     = (c->nPeakCounter + to_do) % c->nPeakDecim;
+                            warm_up             = 0;
+                        }
+                        else if (silent)
+                            dsp::fill_zero(data_y, to_do_upsample);
+                        else if (c->enCoupling_y == CH_COUPLING_AC)
+                        {
+                            c->sDCBlockBank_y.process(s->vTemp, c->vIn_y, to_do);
+                            c->sOversampler_y.upsample(data_y, s->vTemp, to_do);
+                        }
+                        else
+                            c->sOversampler_y.upsample(data_y, c->vIn_y, to_do);
 
+                        // EXT input is processed only when it drives the trigger
+                        if ((!silent) && (c->nPeakDecim == 0) && (c->nInputs & CH_INPUT_EXT))
+                        {
                             if (c->enCoupling_ext == CH_COUPLING_AC)
                             {
-                                c->sDCBlockBank_ext.process(c->vTemp, c->vIn_ext, to_do);
-                                c->sOversampler_ext.upsample(c->vData_ext, c->vTemp, to_do);
+                                c->sDCBlockBank_ext.process(s->vTemp, c->vIn_ext, to_do);
+                                c->sOversampler_ext.upsample(s->vData_ext, s->vTemp, to_do);
                             }
                             else
-                                c->sOversampler_ext.upsample(c->vData_ext, c->vIn_ext, to_do);
+                                c->sOversampler_ext.upsample(s->vData_ext, c->vIn_ext, to_do);
+                        }
 
-                            c->nDataHead = 0;
+                        const float *trg_input = select_trigger_input(s->vData_ext, data_y, c->enTrgInput);
 
-                            const float *trg_input = select_trigger_input(c->vData_ext, c->vData_y, c->enTrgInput);
+                        for (size_t n = warm_up; n < points; )
+                        {
+                            size_t left = points - n;
 
-                            for (size_t n = 0; n < to_do_upsample; ++n)
+                            switch (c->enState)
                             {
-                                c->sTrigger.single_sample_processor(trg_input[n]);
-
-                                switch (c->enState)
+                                case CH_STATE_LISTENING:
                                 {
-                                    case CH_STATE_LISTENING:
+                                    // Do not search for the trigger beyond the auto-sweep position
+                                    size_t count = left;
+                                    if (c->bAutoSweep)
+                                        count       = lsp_min(count, (c->nAutoSweepCounter < c->nAutoSweepLimit) ? c->nAutoSweepLimit - c->nAutoSweepCounter + 1 : 1);
+
+                                    size_t off  = (silent) ?
+                                        trigger_skip(&c->sTrigger, count) :
+                                        trigger_search(&c->sTrigger, &trg_input[n], count);
+                                    bool fired  = off < count;
+                                    if (!fired)
                                     {
-                                        bool sweep = c->sTrigger.get_trigger_state() == dspu::TRG_STATE_FIRED;
-                                        if ((!sweep) && (c->bAutoSweep))
-                                            sweep = ((c->nAutoSweepCounter++) >= c->nAutoSweepLimit);
-
                                         // No sweep triggered?
-                                        if (!sweep)
+                                        if ((!c->bAutoSweep) || (c->nAutoSweepCounter + count <= c->nAutoSweepLimit))
+                                        {
+                                            if (c->bAutoSweep)
+                                                c->nAutoSweepCounter   += count;
+                                            n          += count;
                                             break;
+                                        }
+                                        off         = count - 1;
+                                    }
+
+                                    n          += off;
+
+                                    // The edge is located between the fire sample and the previous one,
+                                    // the sweep is shifted by the distance from the edge to the fire sample
+                                    c->fSweepShift          = 0.0f;
+                                    if ((fired) && (c->nPeakDecim <= 1))
+                                    {
+                                        float prev              = (n > 0) ? trg_input[n - 1] : c->fTrgLast;
+                                        float curr              = trg_input[n];
+                                        if (curr != prev)
+                                            c->fSweepShift          = 1.0f - lsp_limit((c->sTrigger.fFireLevel - prev) / (curr - prev), 0.0f, 1.0f);
+                                    }
 
-                                        c->sSweepGenerator.reset_phase_accumulator();
-                                        c->nDataHead            = n;
-                                        c->enState              = CH_STATE_SWEEPING;
-                                        c->nAutoSweepCounter    = 0;
-                                        c->nDisplayHead         = 0;
+                                    c->nTrgClock            = c->nClock + ((c->nPeakDecim > 0) ? (n * c->nPeakDecim) / 2 : n / c->nOversampling);
+                                    c->nDataHead            = (c->nCaptureHead + n + c->sBufCapacity.nCapture - c->nPreTrigger) % c->sBufCapacity.nCapture;
+                                    c->enState              = CH_STATE_SWEEPING;
+                                    c->nAutoSweepCounter    = 0;
+                                    c->nDisplayHead         = 0;
+                                    c->nDisplaySent         = 0;
+                                    c->nDisplayOut          = 0;
 
-                                        do_sweep_step(c, 1.0f);
+                                    break;
+                                }
 
-                                        break;
+                                case CH_STATE_SWEEPING:
+                                {
+                                    size_t count = lsp_min(left, c->nSweepSize - c->nDisplayHead);
+
+                                    // The trigger keeps tracking the signal, but fires are discarded while sweeping.
+                                    // The sample that has started the sweep is already processed by the trigger.
+                                    size_t k    = (c->nDisplayHead == 0) ? 1 : 0;
+                                    if (silent)
+                                        trigger_skip(&c->sTrigger, count - k);
+                                    else
+                                    {
+                                        for ( ; k < count; ++k)
+                                            k          += trigger_search(&c->sTrigger, &trg_input[n + k], count - k);
                                     }
 
-                                    case CH_STATE_SWEEPING:
-                                        do_sweep_step(c, 0.0f);
+                                    do_sweep(c, count);
+                                    n          += count;
 
-                                        if (c->nDisplayHead >= c->nSweepSize)
-                                        {
-                                            // Plot time!
-                                            if (graph_stream(c))
-                                                query_draw      = true;
-                                            c->enState      = CH_STATE_LISTENING;
-                                        }
-                                        break;
+                                    if (c->nDisplayHead >= c->nSweepSize)
+                                    {
+                                        // Plot time!
+                                        if (complete_trace(c))
+                                            query_draw      = true;
+                                        c->enState      = CH_STATE_LISTENING;
+                                    }
+                                    break;
                                 }
                             }
                         }
-                        break;
+
+                        if (points > 0)
+                            c->fTrgLast         = (silent) ? 0.0f : trg_input[points - 1];
+
+                        // Update the capture buffer write position
+                        c->nCaptureHead    += points;
+                        if (c->nCaptureHead >= c->sBufCapacity.nCapture)
+                            c->nCaptureHead     = 0;
                     }
+                    break;
+                }
+
+                c->vIn_x            += to_do;
+                c->vIn_y            += to_do;
+                c->vIn_ext          += to_do;
+                c->vOut_x           += to_do;
+                c->vOut_y           += to_do;
+                c->nSamplesCounter  -= to_do;
+                c->nClock          += to_do;
+            }
+
+            return query_draw;
+        }
+
+        bool oscilloscope::process_channels(const ch_scratch_t *s)
+        {
+            // Do not touch the counter until the next job is published
+            if (atomic_load(&nJobNext) >= nChannels)
+                return false;
+
+            bool worked = false;
+            while (true)
+            {
+                uatomic_t index     = atomic_add(&nJobNext, uatomic_t(1));
+                if (index >= nChannels)
+                    break;
+
+                channel_t *c        = &vChannels[index];
+                c->bQueryDraw       = process_channel(c, nJobSamples, s);
+                atomic_add(&nJobDone, uatomic_t(1));
+                worked              = true;
+            }
+
+            return worked;
+        }
 
-                    c->vIn_x            += to_do;
-                    c->vIn_y            += to_do;
-                    c->vIn_ext          += to_do;
-                    c->vOut_x           += to_do;
-                    c->vOut_y           += to_do;
-                    c->nSamplesCounter  -= to_do;
+        void oscilloscope::process(size_t samples)
+        {
+            // Prepare channels
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c = &vChannels[ch];
+
+                c->vIn_x    = c->pIn_x->buffer<float>();
+                c->vIn_y    = c->pIn_y->buffer<float>();
+                c->vIn_ext  = c->pIn_ext->buffer<float>();
+
+                c->vOut_x   = c->pOut_x->buffer<float>();
+                c->vOut_y   = c->pOut_y->buffer<float>();
+
+                if ((c->vIn_x == NULL) || (c->vIn_y == NULL))
+                    return;
+
+                if (c->vIn_ext == NULL)
+                    return;
+
+                c->nSamplesCounter = samples;
+            }
+
+            // Bypass signal
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c = &vChannels[ch];
+
+                if (c->vOut_x != NULL)
+                    dsp::copy(c->vOut_x, c->vIn_x, samples);
+                if (c->vOut_y != NULL)
+                    dsp::copy(c->vOut_y, c->vIn_y, samples);
+            }
+
+            bool query_draw = false;
+
+            // Background tasks are submitted to the executor of the wrapper
+            pExecutor       = (pWrapper != NULL) ? pWrapper->executor() : NULL;
+
+            // Pass traces decimated in background to the UI
+            if ((pDecimator != NULL) && (pDecimator->completed()))
+            {
+                pDecimator->reset();
+                if (plot_frames())
+                    query_draw      = true;
+                if (plot_segments())
+                    query_draw      = true;
+            }
+
+            // Bind re-allocated display buffers and request new ones if needed
+            update_arena(samples);
+
+            // Worker threads are started once in background when the parallel processing is enabled
+            if (pLauncher != NULL)
+            {
+                if ((bParallel) && (pExecutor != NULL) && (pLauncher->idle()))
+                    pExecutor->submit(pLauncher);
+                else if (pLauncher->completed())
+                    bWorkers            = pLauncher->successful();
+            }
+
+            // Process channels, workers may take some of them in parallel
+            nJobHold            = (nJobHold > samples) ? nJobHold - samples : 0;
+            if ((bParallel) && (bWorkers) && (nJobHold <= 0) && (nWorkers > 0) && (samples >= PARALLEL_MIN_SAMPLES))
+            {
+                nJobSamples         = samples;
+                atomic_store(&nJobDone, uatomic_t(0));
+                atomic_store(&nJobNext, uatomic_t(0));
+
+                // Wake up workers without blocking: a worker missing the notification
+                // just leaves its channels to the audio thread
+                if (sJobEvent.try_lock())
+                {
+                    sJobEvent.notify_all();
+                    sJobEvent.unlock();
+                }
+
+                // Process channels not claimed by workers, then wait only for channels
+                // which are being processed by running workers at the moment. A preempted
+                // worker stalls the audio thread, so channels are processed serially for
+                // a while after workers have been late.
+                process_channels(&vScratch[0]);
+                for (size_t spin = 0; atomic_load(&nJobDone) < nChannels; ++spin)
+                {
+                    if (spin < PARALLEL_SPIN_COUNT)
+                        continue;
+                    ipc::Thread::yield();
+                    nJobHold            = dspu::seconds_to_samples(fSampleRate, PARALLEL_HOLD_TIME);
+                }
+            }
+            else
+            {
+                for (size_t ch = 0; ch < nChannels; ++ch)
+                {
+                    channel_t *c        = &vChannels[ch];
+                    c->bQueryDraw       = process_channel(c, samples, &vScratch[0]);
+                }
+            }
+
+            // Complete acquisition left by workers and pass the data to the streams
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c        = &vChannels[ch];
+                if (c->bResume)
+                {
+                    c->bResume          = false;
+                    if (acquire_channel(c, &vScratch[0]))
+                        c->bQueryDraw       = true;
+                }
+
+                // Submit the part of the long sweep acquired during this period
+                if ((c->bProgressive) && (c->enMode == CH_MODE_TRIGGERED) && (!is_averaging(c)) &&
+                    (!c->bSuspended) && (c->enState == CH_STATE_SWEEPING) && (c->nDisplayHead > c->nDisplaySent))
+                    graph_stream(c, false);
+
+                if (c->bQueryDraw)
+                    query_draw          = true;
+            }
+
+            // Pass the phosphor images and batches of segments to the UI
+            plot_phosphor(samples);
+            queue_segments(samples);
+
+            // Decimate completed traces in background. While the decimator is busy,
+            // pending traces wait for the next block instead of being decimated here.
+            if ((pExecutor != NULL) && (pDecimator != NULL) && (pDecimator->idle()))
+            {
+                bool pending = false;
+                for (size_t ch = 0; ch < nChannels; ++ch)
+                {
+                    const channel_t *c  = &vChannels[ch];
+                    if ((atomic_load(&c->nFrameState) == CH_FRAME_PENDING) ||
+                        (atomic_load(&c->nSegState) == CH_FRAME_PENDING))
+                        pending         = true;
                 }
+
+                if (pending)
+                    pExecutor->submit(pDecimator);
             }
 
             if ((pWrapper != NULL) && (query_draw))
@@ -1332,6 +3578,15 @@ namespace lsp
             v->end_object();
 
             v->write("nChannels", nChannels);
+            v->write("fSilence", fSilence);
+            v->write("nMaxDots", nMaxDots);
+            v->write("bPhosphor", bPhosphor);
+            v->write("fPhosphorDecay", fPhosphorDecay);
+            v->write("nPhosphorCounter", nPhosphorCounter);
+            v->write("nSegments", nSegments);
+            v->write("nSegmentCounter", nSegmentCounter);
+            v->write("enAcquisition", enAcquisition);
+            v->write("nAverage", nAverage);
 
             v->begin_array("vChannels", vChannels, nChannels);
             for (size_t i = 0; i < nChannels; ++i)
@@ -1346,6 +3601,7 @@ namespace lsp
                     v->write("enCoupling_x", &c->enCoupling_x);
                     v->write("enCoupling_y", &c->enCoupling_y);
                     v->write("enCoupling_ext", &c->enCoupling_ext);
+                    v->write("nInputs", c->nInputs);
 
                     v->write_object("sDCBlockBank_x", &c->sDCBlockBank_x);
                     v->write_object("sDCBlockBank_y", &c->sDCBlockBank_y);
@@ -1359,32 +3615,143 @@ namespace lsp
                     v->write_object("sOversampler_y", &c->sOversampler_y);
                     v->write_object("sOversampler_ext", &c->sOversampler_ext);
 
-                    v->write_object("sPreTrgDelay", &c->sPreTrgDelay);
-
-                    v->write_object("sTrigger", &c->sTrigger);
+                    v->begin_object("sTrigger", &c->sTrigger, sizeof(ch_trigger_t));
+                    {
+                        const ch_trigger_t *t = &c->sTrigger;
+
+                        v->write("enMode", t->enMode);
+                        v->write("enType", t->enType);
+                        v->write("fArmLevel", t->fArmLevel);
+                        v->write("fFireLevel", t->fFireLevel);
+                        v->write("nHold", t->nHold);
+                        v->write("nHoldCounter", t->nHoldCounter);
+                        v->write("bRising", t->bRising);
+                        v->write("bArmed", t->bArmed);
+                        v->write("bSingleLock", t->bSingleLock);
+                        v->write("bManualAllow", t->bManualAllow);
+                    }
+                    v->end_object();
+                    v->write("bBaseTrigger", c->bBaseTrigger);
+                    v->write("fTrgLast", c->fTrgLast);
+                    v->write("fSweepShift", c->fSweepShift);
+                    v->write("fFrameShift", c->fFrameShift);
 
                     v->write_object("sSweepGenerator", &c->sSweepGenerator);
 
-                    v->write("vTemp", &c->vTemp);
-                    v->write("vData_x", &c->vData_x);
-                    v->write("vData_y", &c->vData_y);
-                    v->write("vData_ext", &c->vData_ext);
-                    v->write("vData_y_delay", &c->vData_y_delay);
+                    v->write("vCapture", &c->vCapture);
+                    v->write("vSweep", &c->vSweep);
+                    v->write("vPhosphor", c->vPhosphor);
+                    v->write("vSegments", c->vSegments);
+                    v->begin_array("vSegment", c->vSegment, meta::oscilloscope_metadata::SEGMENTS_MAX);
+                    for (size_t j=0; j<meta::oscilloscope_metadata::SEGMENTS_MAX; ++j)
+                    {
+                        const ch_segment_t *sg = &c->vSegment[j];
+                        v->begin_object(sg, sizeof(ch_segment_t));
+                        {
+                            v->write("nSize", sg->nSize);
+                            v->write("nTime", sg->nTime);
+                            v->write("fTime", sg->fTime);
+                            v->write("fShift", sg->fShift);
+                        }
+                        v->end_object();
+                    }
+                    v->end_array();
+                    v->write("nSegHead", c->nSegHead);
+                    v->write("nSegCount", c->nSegCount);
+                    v->write("nSegBatch", c->nSegBatch);
+                    v->write("nSegState", c->nSegState);
+                    v->write("nClock", c->nClock);
+                    v->write("nTrgClock", c->nTrgClock);
+                    v->write("vAverage", c->vAverage);
+                    v->write("fAvgShift", c->fAvgShift);
+                    v->write("nAvgCount", c->nAvgCount);
+                    v->write("nAvgSweeps", c->nAvgSweeps);
                     v->write("vDisplay_x", &c->vDisplay_x);
                     v->write("vDisplay_y", &c->vDisplay_y);
-                    v->write("vDisplay_s", &c->vDisplay_s);
-
-                    v->write("vIDisplay_x", &c->vIDisplay_x);
-                    v->write("vIDisplay_y", &c->vIDisplay_y);
-                    v->write("nIDisplay", &c->nIDisplay);
+                    v->write("vFrame_x", c->vFrame_x);
+                    v->write("vFrame_y", c->vFrame_y);
+                    v->write("nFrameSize", c->nFrameSize);
+                    v->write("nFrameState", c->nFrameState);
+
+                    v->write("vIDisplayBuf", c->vIDisplayBuf);
+                    v->write("nIDisplaySize", c->nIDisplaySize);
+                    v->begin_array("vIDisplay", c->vIDisplay, 3);
+                    for (size_t j=0; j<3; ++j)
+                    {
+                        const ch_snapshot_t *sn = &c->vIDisplay[j];
+                        v->begin_object(sn, sizeof(ch_snapshot_t));
+                        {
+                            v->write("vX", sn->vX);
+                            v->write("vY", sn->vY);
+                            v->write("nSize", sn->nSize);
+                            v->write("nSeq", sn->nSeq);
+                            v->write("nGen", sn->nGen);
+                        }
+                        v->end_object();
+                    }
+                    v->end_array();
+                    v->write("nIDisplayLatest", c->nIDisplayLatest);
+                    v->write("nIDisplayWrite", c->nIDisplayWrite);
+                    v->write("nIDisplayRead", c->nIDisplayRead);
+                    v->write("nIDisplaySeq", c->nIDisplaySeq);
+                    v->write("nIDisplayDrawn", c->nIDisplayDrawn);
+                    v->write("bIDisplayVisible", c->bIDisplayVisible);
+
+                    v->begin_object("sBufCapacity", &c->sBufCapacity, sizeof(ch_buffers_t));
+                    {
+                        v->write("nDisplay", c->sBufCapacity.nDisplay);
+                        v->write("nCapture", c->sBufCapacity.nCapture);
+                        v->write("nSweep", c->sBufCapacity.nSweep);
+                        v->write("nPhosphor", c->sBufCapacity.nPhosphor);
+                        v->write("nSegments", c->sBufCapacity.nSegments);
+                        v->write("nAverage", c->sBufCapacity.nAverage);
+                    }
+                    v->end_object();
+                    v->begin_object("sBufRequest", &c->sBufRequest, sizeof(ch_buffers_t));
+                    {
+                        v->write("nDisplay", c->sBufRequest.nDisplay);
+                        v->write("nCapture", c->sBufRequest.nCapture);
+                        v->write("nSweep", c->sBufRequest.nSweep);
+                        v->write("nPhosphor", c->sBufRequest.nPhosphor);
+                        v->write("nSegments", c->sBufRequest.nSegments);
+                        v->write("nAverage", c->sBufRequest.nAverage);
+                    }
+                    v->end_object();
+                    v->begin_object("sBufPending", &c->sBufPending, sizeof(ch_buffers_t));
+                    {
+                        v->write("nDisplay", c->sBufPending.nDisplay);
+                        v->write("nCapture", c->sBufPending.nCapture);
+                        v->write("nSweep", c->sBufPending.nSweep);
+                        v->write("nPhosphor", c->sBufPending.nPhosphor);
+                        v->write("nSegments", c->sBufPending.nSegments);
+                        v->write("nAverage", c->sBufPending.nAverage);
+                    }
+                    v->end_object();
 
+                    v->write("nCaptureHead", &c->nCaptureHead);
                     v->write("nDataHead", &c->nDataHead);
                     v->write("nDisplayHead", &c->nDisplayHead);
+                    v->write("nDisplaySent", c->nDisplaySent);
+                    v->write("nDisplayOut", c->nDisplayOut);
                     v->write("nSamplesCounter", &c->nSamplesCounter);
+                    v->write("nWarmUp", c->nWarmUp);
                     v->write("bClearStream", &c->bClearStream);
+                    v->write("bSuspended", c->bSuspended);
+                    v->write("bSilent", c->bSilent);
+                    v->write("bProgressive", c->bProgressive);
+                    v->write("bQueryDraw", c->bQueryDraw);
+                    v->write("bResume", c->bResume);
 
                     v->write("nPreTrigger", &c->nPreTrigger);
                     v->write("nSweepSize", &c->nSweepSize);
+                    v->write("nPeakDecim", c->nPeakDecim);
+                    v->write("nPeakCounter", c->nPeakCounter);
+                    v->write("sPeak_y.fMin", c->sPeak_y.fMin);
+                    v->write("sPeak_y.fMax", c->sPeak_y.fMax);
+                    v->write("sPeak_ext.fMin", c->sPeak_ext.fMin);
+                    v->write("sPeak_ext.fMax", c->sPeak_ext.fMax);
+                    v->write("nSweepSkip", c->nSweepSkip);
+                    v->write("nSweepLeft", c->nSweepLeft);
 
                     v->write("fVerStreamScale", &c->fVerStreamScale);
                     v->write("fVerStreamOffset", &c->fVerStreamOffset);
@@ -1425,6 +3792,7 @@ namespace lsp
                         v->write("nPV_pSweepType", &c->sStateStage.nPV_pSweepType);
 
                         v->write("fPV_pXYRecordTime", &c->sStateStage.fPV_pXYRecordTime);
+                        v->write("bPV_pBaseTrigger", c->sStateStage.bPV_pBaseTrigger);
                     }
                     v->end_object();
 
@@ -1473,6 +3841,7 @@ namespace lsp
                     v->write("pMuteSwitch", &c->pMuteSwitch);
 
                     v->write("pStream", &c->pStream);
+                    v->write("pFrameBuffer", c->pFrameBuffer);
                 }
                 v->end_object();
             }
@@ -1480,11 +3849,62 @@ namespace lsp
 
             v->write("pData", pData);
 
+            size_t scratches = (vScratch != NULL) ? nWorkers + 1 : 0;
+            v->begin_array("vScratch", vScratch, scratches);
+            for (size_t i = 0; i < scratches; ++i)
+            {
+                const ch_scratch_t *s = &vScratch[i];
+
+                v->begin_object(s, sizeof(ch_scratch_t));
+                {
+                    v->write("vTemp", s->vTemp);
+                    v->write("vData_x", s->vData_x);
+                    v->write("vData_y", s->vData_y);
+                    v->write("vData_ext", s->vData_ext);
+                }
+                v->end_object();
+            }
+            v->end_array();
+
+            v->write("bParallel", bParallel);
+            v->write("nWorkers", nWorkers);
+            v->write("vWorkers", vWorkers);
+            v->write("pLauncher", pLauncher);
+            v->write("pWorkerData", pWorkerData);
+            v->write("bWorkers", bWorkers);
+            v->write("nJobSamples", nJobSamples);
+            v->write("nJobNext", nJobNext);
+            v->write("nJobDone", nJobDone);
+            v->write("nJobHold", nJobHold);
+            v->write("vStrobe", vStrobe);
+
+            v->write("pDecimator", pDecimator);
+            v->write("pExecutor", pExecutor);
+            v->write("pArenaAllocator", pArenaAllocator);
+            v->write("pArena", pArena);
+            v->write("pArenaNew", pArenaNew);
+            v->write("pArenaGarbage", pArenaGarbage);
+            v->write("pArenaRelease", pArenaRelease);
+            v->write("vArenaNew", vArenaNew);
+            v->write("bArenaAlloc", bArenaAlloc);
+            v->write("nArenaRetry", nArenaRetry);
+            v->write("nArenaGen", nArenaGen);
+
             v->write("pStrobeHistSize", pStrobeHistSize);
             v->write("pXYRecordTime", pXYRecordTime);
+            v->write("pMaxDots", pMaxDots);
+            v->write("pSilenceGate", pSilenceGate);
+            v->write("pSilence", pSilence);
+            v->write("pBaseTrigger", pBaseTrigger);
+            v->write("pPhosphor", pPhosphor);
+            v->write("pPhosphorDecay", pPhosphorDecay);
+            v->write("pSegments", pSegments);
+            v->write("pAcquisition", pAcquisition);
+            v->write("pAverage", pAverage);
             v->write("pFreeze", pFreeze);
 
             v->write("pChannelSelector", pChannelSelector);
+            v->write("pParallel", pParallel);
 
             v->write("pOvsMode", pOvsMode);
             v->write("pScpMode", pScpMode);
@@ -1509,6 +3929,12 @@ namespace lsp
             v->write("pTrgReset", pTrgReset);
 
             v->write("pIDisplay", pIDisplay);
+            v->write("nIDisplayBusy", nIDisplayBusy);
+            v->write("nIDisplayWidth", nIDisplayWidth);
+            v->write("nIDisplayHeight", nIDisplayHeight);
+            v->write("pIDisplayLayer", pIDisplayLayer);
+            v->write("vIDisplayLayer", vIDisplayLayer);
+            v->write("nIDisplayLayer", nIDisplayLayer);
         }
 
         static const uint32_t ch_colors[] =
@@ -1536,21 +3962,65 @@ namespace lsp
                 return false;
             width   = cv->width();
             height  = cv->height();
-            float cx    = width >> 1;
-            float cy    = height >> 1;
 
-            // Clear background
-            cv->paint();
+            // Take the latest snapshots, keep the previous image if nothing has changed
+            bool resized    = (width != nIDisplayWidth) || (height != nIDisplayHeight);
+            bool redraw     = resized;
+            for (size_t ch = 0; ch < nChannels; ++ch)
+            {
+                channel_t *c = &vChannels[ch];
+                fetch_snapshot(c);
+                if ((c->vIDisplay[c->nIDisplayRead].nSeq != c->nIDisplayDrawn) ||
+                    (c->bVisible != c->bIDisplayVisible))
+                    redraw      = true;
+            }
+            if (!redraw)
+                return true;
+
+            nIDisplayWidth  = width;
+            nIDisplayHeight = height;
+            if (resized)
+                nIDisplayLayer  = 0;
+
+            // Restore the background with axis from the cache
+            uint8_t *pixels = (nIDisplayLayer > 0) ? static_cast<uint8_t *>(cv->start_direct()) : NULL;
+            if (pixels != NULL)
+            {
+                memcpy(pixels, vIDisplayLayer, nIDisplayLayer);
+                cv->end_direct();
+            }
+            else
+            {
+                float cx    = width >> 1;
+                float cy    = height >> 1;
 
-            // Draw axis
-            cv->set_line_width(1.0);
-            cv->set_color_rgb(CV_SILVER, 0.5f);
-            cv->line(0, 0, width, height);
-            cv->line(0, height, width, 0);
+                // Clear background
+                cv->paint();
 
-            cv->set_color_rgb(CV_WHITE, 0.5f);
-            cv->line(cx, 0, cx, height);
-            cv->line(0, cy, width, cy);
+                // Draw axis
+                cv->set_line_width(1.0);
+                cv->set_color_rgb(CV_SILVER, 0.5f);
+                cv->line(0, 0, width, height);
+                cv->line(0, height, width, 0);
+
+                cv->set_color_rgb(CV_WHITE, 0.5f);
+                cv->line(cx, 0, cx, height);
+                cv->line(0, cy, width, cy);
+
+                // Store the background to the cache, it is rendered once for the canvas size
+                const plug::canvas_data_t *cd = cv->get_data();
+                if ((cd != NULL) && (cd->pData != NULL))
+                {
+                    size_t bytes    = cd->nStride * cd->nHeight;
+                    free_aligned(pIDisplayLayer);
+                    vIDisplayLayer  = alloc_aligned<uint8_t>(pIDisplayLayer, bytes);
+                    if (vIDisplayLayer != NULL)
+                    {
+                        memcpy(vIDisplayLayer, cd->pData, bytes);
+                        nIDisplayLayer  = bytes;
+                    }
+                }
+            }
 
             // Check for solos:
             const uint32_t *cols =
@@ -1564,7 +4034,10 @@ namespace lsp
             // Estimate the display length
             size_t di_length = 1;
             for (size_t ch = 0; ch < nChannels; ++ch)
-                di_length = lsp_max(di_length, vChannels[ch].nIDisplay);
+            {
+                const channel_t *c = &vChannels[ch];
+                di_length = lsp_max(di_length, c->vIDisplay[c->nIDisplayRead].nSize);
+            }
 
             // Allocate buffer: t, f(t)
             pIDisplay = core::IDBuffer::reuse(pIDisplay, 2, di_length);
@@ -1574,18 +4047,27 @@ namespace lsp
 
             bool aa = cv->set_anti_aliasing(true);
 
+            // Snapshots bound to the previous arena are not accessed, the audio thread
+            // releases the previous arena only when the inline display is not busy
+            atomic_store(&nIDisplayBusy, 1);
+            size_t gen = atomic_load(&nArenaGen);
+
             for (size_t ch = 0; ch < nChannels; ++ch)
             {
                 channel_t *c = &vChannels[ch];
-                if (!c->bVisible)
+                const ch_snapshot_t *sn = &c->vIDisplay[c->nIDisplayRead];
+                c->nIDisplayDrawn   = sn->nSeq;
+                c->bIDisplayVisible = c->bVisible;
+                if ((!c->bVisible) || (sn->nGen != gen))
                     continue;
 
-                size_t dlen = lsp_min(c->nIDisplay, di_length);
-                for (size_t i=0; i<dlen; ++i)
-                {
-                    b->v[0][i] = halfv * (c->vIDisplay_x[i] + 1.0f);
-                    b->v[1][i] = halfh * (-c->vIDisplay_y[i] + 1.0f);
-                }
+                // Transform to the canvas coordinates and keep at most two points per pixel column
+                size_t dlen = lsp_min(sn->nSize, di_length);
+                dsp::mul_k3(b->v[0], sn->vX, halfv, dlen);
+                dsp::add_k2(b->v[0], halfv, dlen);
+                dsp::mul_k3(b->v[1], sn->vY, -halfh, dlen);
+                dsp::add_k2(b->v[1], halfh, dlen);
+                dlen        = decimate_columns(b->v[0], b->v[1], b->v[0], b->v[1], dlen, 0.0f, width, width);
 
                 // Set color and draw
                 cv->set_color_rgb(cols[ch]);
@@ -1593,6 +4075,7 @@ namespace lsp
                 cv->draw_lines(b->v[0], b->v[1], dlen);
             }
 
+            atomic_store(&nIDisplayBusy, 0);
             cv->set_anti_aliasing(aa);
 
             return true;
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of lsp-plugins-oscilloscope
+ * Created on: 17 окт. 2026 г.
+ *
+ * lsp-plugins-oscilloscope is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * lsp-plugins-oscilloscope is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with lsp-plugins-oscilloscope. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/alloc.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUF_LIM_SIZE        196608
+#define DECIM_PRECISION     0.1e-5
+#define DECIM_BLOCK_MIN     0x04
+#define DECIM_BLOCK_MAX     0x40
+#define DECIM_SKIP_RUN      0x08
+#define DECIM_SKIP_BLOCK    0x10
+
+/**
+ * Candidate decimation kernels of the oscilloscope. The scalar kernel is the copy of decimate()
+ * from the plugin, other kernels should produce exactly the same output. Each kernel is checked
+ * against the scalar one before it is measured.
+ */
+namespace lsp
+{
+    namespace osc_decimate
+    {
+        size_t scalar(float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count, float precision)
+        {
+            if (count <= 0)
+                return 0;
+
+            float rx        = src_x[0];
+            float ry        = src_y[0];
+            size_t j        = 0;
+
+            dst_x[0]        = rx;
+            dst_y[0]        = ry;
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                float dx        = src_x[i] - rx;
+                float dy        = src_y[i] - ry;
+                if ((dx*dx + dy*dy) < precision)
+                    continue;
+
+                ++j;
+                rx              = src_x[i];
+                ry              = src_y[i];
+                dst_x[j]        = rx;
+                dst_y[j]        = ry;
+            }
+
+            return j + 1;
+        }
+
+        // Distances to the last kept point are computed for the block of points at once,
+        // the block grows while all points of the block are dropped
+        size_t block(float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count, float precision)
+        {
+            if (count <= 0)
+                return 0;
+
+            float dist[DECIM_BLOCK_MAX];
+            float rx        = src_x[0];
+            float ry        = src_y[0];
+            size_t block    = DECIM_BLOCK_MIN;
+            size_t j        = 0;
+
+            dst_x[0]        = rx;
+            dst_y[0]        = ry;
+
+            for (size_t i = 1; i < count; )
+            {
+                size_t to_do    = lsp_min(count - i, block);
+                const float *px = &src_x[i];
+                const float *py = &src_y[i];
+                for (size_t k=0; k<to_do; ++k)
+                {
+                    float dx        = px[k] - rx;
+                    float dy        = py[k] - ry;
+                    dist[k]         = dx*dx + dy*dy;
+                }
+
+                size_t k        = 0;
+                while ((k < to_do) && (dist[k] < precision))
+                    ++k;
+                i              += k;
+
+                if (k >= to_do)
+                {
+                    block           = lsp_min(block << 1, size_t(DECIM_BLOCK_MAX));
+                    continue;
+                }
+
+                ++j;
+                rx              = src_x[i];
+                ry              = src_y[i];
+                dst_x[j]        = rx;
+                dst_y[j]        = ry;
+
+                block           = DECIM_BLOCK_MIN;
+                ++i;
+            }
+
+            return j + 1;
+        }
+
+        // The scalar loop which skips whole blocks of dropped points after a long enough run
+        // of dropped points, the block is checked with the branch-free reduction
+        size_t skip(float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count, float precision)
+        {
+            if (count <= 0)
+                return 0;
+
+            float rx        = src_x[0];
+            float ry        = src_y[0];
+            size_t j        = 0;
+            size_t run      = 0;
+
+            dst_x[0]        = rx;
+            dst_y[0]        = ry;
+
+            for (size_t i = 1; i < count; ++i)
+            {
+                float dx        = src_x[i] - rx;
+                float dy        = src_y[i] - ry;
+                if ((dx*dx + dy*dy) < precision)
+                {
+                    if ((++run) < DECIM_SKIP_RUN)
+                        continue;
+
+                    for (run = 0; i + DECIM_SKIP_BLOCK < count; i += DECIM_SKIP_BLOCK)
+                    {
+                        const float *px = &src_x[i + 1];
+                        const float *py = &src_y[i + 1];
+                        int keep        = 0;
+                        for (size_t k=0; k<DECIM_SKIP_BLOCK; ++k)
+                        {
+                            float ex        = px[k] - rx;
+                            float ey        = py[k] - ry;
+                            keep           |= !((ex*ex + ey*ey) < precision);
+                        }
+                        if (keep)
+                            break;
+                    }
+                    continue;
+                }
+
+                run             = 0;
+                ++j;
+                rx              = src_x[i];
+                ry              = src_y[i];
+                dst_x[j]        = rx;
+                dst_y[j]        = ry;
+            }
+
+            return j + 1;
+        }
+    }
+}
+
+typedef size_t (* decimate_t)(float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count, float precision);
+
+PTEST_BEGIN("oscilloscope", decimate, 5, 1000)
+
+    void call(const char *label, float *dst_x, float *dst_y, const float *src_x, const float *src_y, size_t count, decimate_t func)
+    {
+        char buf[0x100];
+        snprintf(buf, sizeof(buf), "%s x %d", label, int(count));
+
+        // Check that the kernel matches the scalar one
+        float *ref_x    = &dst_x[count];
+        float *ref_y    = &dst_y[count];
+        size_t ref      = osc_decimate::scalar(ref_x, ref_y, src_x, src_y, count, DECIM_PRECISION);
+        size_t kept     = func(dst_x, dst_y, src_x, src_y, count, DECIM_PRECISION);
+        if ((kept != ref) ||
+            (memcmp(dst_x, ref_x, kept * sizeof(float)) != 0) ||
+            (memcmp(dst_y, ref_y, kept * sizeof(float)) != 0))
+        {
+            printf("Kernel %s does not match the scalar kernel: %d vs %d points\n", buf, int(kept), int(ref));
+            return;
+        }
+
+        printf("Testing %s points, %d kept...\n", buf, int(kept));
+
+        PTEST_LOOP(buf,
+            func(dst_x, dst_y, src_x, src_y, count, DECIM_PRECISION);
+        );
+    }
+
+    void trace(float *x, float *y, size_t count, size_t type)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            switch (type)
+            {
+                case 0: // Noise, all points are kept
+                    x[i]    = float(rand()) / RAND_MAX * 2.0f - 1.0f;
+                    y[i]    = float(rand()) / RAND_MAX * 2.0f - 1.0f;
+                    break;
+                case 1: // XY trace of two sines, most points are kept
+                    x[i]    = sinf(i * 0.003f);
+                    y[i]    = 0.7f * cosf(i * 0.0031f);
+                    break;
+                case 2: // Oversampled sweep, short runs of dropped points
+                    x[i]    = 2.0f * i / count - 1.0f;
+                    y[i]    = sinf(i * 0.0002f);
+                    break;
+                case 3: // Every second point is dropped
+                    x[i]    = (i >> 1) * 0.01f;
+                    y[i]    = 0.0f;
+                    break;
+                default: // Constant signal, one point is kept
+                    x[i]    = 0.5f;
+                    y[i]    = 0.5f;
+                    break;
+            }
+        }
+    }
+
+    PTEST_MAIN
+    {
+        static const char *traces[] = { "noise", "xy", "sweep", "alternate", "constant" };
+
+        size_t buf_size = BUF_LIM_SIZE;
+        uint8_t *data   = NULL;
+        float *src_x    = alloc_aligned<float>(data, buf_size * 6, 64);
+        float *src_y    = &src_x[buf_size];
+        float *dst_x    = &src_y[buf_size];
+        float *dst_y    = &dst_x[buf_size * 2];
+
+        for (size_t i=0; i<sizeof(traces)/sizeof(const char *); ++i)
+        {
+            char label[80];
+            trace(src_x, src_y, buf_size, i);
+
+            snprintf(label, sizeof(label), "scalar %s", traces[i]);
+            call(label, dst_x, dst_y, src_x, src_y, buf_size, osc_decimate::scalar);
+            snprintf(label, sizeof(label), "block %s", traces[i]);
+            call(label, dst_x, dst_y, src_x, src_y, buf_size, osc_decimate::block);
+            snprintf(label, sizeof(label), "skip %s", traces[i]);
+            call(label, dst_x, dst_y, src_x, src_y, buf_size, osc_decimate::skip);
+            PTEST_SEPARATOR;
+        }
+
+        free_aligned(data);
+    }
+
+PTEST_END